@@ -18,8 +18,16 @@
 #include "NotificationService.h"
 
 #include "LSUtils.h"
+#include "Settings.h"
+#include "IconCache.h"
 
 #include <string>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <Utils.h>
 #include <JUtil.h>
 #include <Logging.h>
@@ -27,7 +35,13 @@
 
 static AppList* s_applist_instance = 0;
 
+#define APPLIST_SNAPSHOT_HEADER "applist 1\n"
+#define APPLIST_SNAPSHOT_DELAY_MS 2000
+
 AppList::AppList()
+	: m_generation(0)
+	, m_revision(0)
+	, m_snapshotTimer(0)
 {
 	s_applist_instance = this;
 	init();
@@ -35,6 +49,12 @@ AppList::AppList()
 
 AppList::~AppList()
 {
+	if (m_snapshotTimer)
+	{
+		g_source_remove(m_snapshotTimer);
+		saveSnapshot();
+	}
+
 	s_applist_instance = 0;
 }
 
@@ -49,6 +69,9 @@ AppList* AppList::instance()
 
 void AppList::init()
 {
+	// Serve lookups from the last known list until listApps replies
+	loadSnapshot();
+
 	bool result;
 	LSError lsError;
 	LSErrorInit(&lsError);
@@ -124,9 +147,11 @@ bool AppList::cbAppMgrAppList(LSHandle* lshandle, LSMessage *message, void *user
 		if (!apps.isArray())
 			return false;
 
-		AppList::instance()->removeAllList();
+		AppList* appList = AppList::instance();
+		appList->m_generation++;
 		for(ssize_t index = 0; index < apps.arraySize(); index++)
-			AppList::instance()->handleAppResponse("added", apps[index]);
+			appList->handleAppResponse("updated", apps[index]);
+		appList->sweepList();
 	}
 	else if (response.hasKey("app"))
 	{
@@ -155,65 +180,193 @@ void AppList::handleAppResponse(const std::string& change, pbnjson::JValue app)
 		removeFromList(id);
 }
 
+bool AppList::lookup(const std::string& id, std::string* icon) const
+{
+	auto it = m_applist.find(id);
+	if (it == m_applist.end())
+		return false;
+
+	if (icon)
+		*icon = it->second.icon;
+	return true;
+}
+
 bool AppList::isAppExist(const std::string& id)
 {
-	for(std::list<AppInfo>::const_iterator it = m_applist.begin(); it != m_applist.end(); ++it)
-	{
-		const AppInfo& item = (*it);
-		if(item.appId == id) {
-			return true;
-		}
-	}
-	return false;
+	return lookup(id);
 }
 
 std::string AppList::getIcon(const std::string& id)
 {
-	for(std::list<AppInfo>::const_iterator it = m_applist.begin(); it != m_applist.end(); ++it)
-	{
-		const AppInfo& item = (*it);
-		if(item.appId == id) {
-			return item.icon;
-		}
-	}
-	return "";
+	std::string icon;
+	lookup(id, &icon);
+	return icon;
 }
 
 void AppList::addToList(const std::string& id, const std::string& icon)
 {
-	AppInfo appInfo;
-	appInfo.appId = id;
+	auto it = m_applist.find(id);
+	if (it != m_applist.end() && it->second.icon == icon)
+	{
+		it->second.generation = m_generation;
+		return;
+	}
+
+	AppInfo& appInfo = m_applist[id];
 	appInfo.icon = icon;
-	m_applist.push_back(appInfo);
+	appInfo.generation = m_generation;
+	m_revision++;
+	IconCache::instance().prewarm(icon);
+	scheduleSnapshot();
 }
 
 void AppList::updateFromList(const std::string &id, const std::string &icon)
 {
-	for(auto &item : m_applist)
+	addToList(id, icon);
+}
+
+void AppList::removeFromList(const std::string& id)
+{
+	if (m_applist.erase(id))
+	{
+		m_revision++;
+		scheduleSnapshot();
+	}
+}
+
+void AppList::sweepList()
+{
+	size_t removed = 0;
+	for (auto it = m_applist.begin(); it != m_applist.end(); )
 	{
-		if (item.appId == id)
+		if (it->second.generation != m_generation)
+		{
+			it = m_applist.erase(it);
+			removed++;
+		}
+		else
 		{
-			item.icon = icon;
-			return;
+			++it;
 		}
 	}
 
-	addToList(id, icon);
+	if (removed)
+	{
+		m_revision++;
+		scheduleSnapshot();
+	}
+
+	LOG_DEBUG("AppList synced: %zu apps, %zu removed", m_applist.size(), removed);
 }
 
-void AppList::removeFromList(const std::string& id)
+void AppList::loadSnapshot()
 {
-	for(std::list<AppInfo>::iterator it = m_applist.begin(); it != m_applist.end(); ++it)
-    {
-		AppInfo& item = (*it);
-        if(item.appId == id) {
-			m_applist.erase(it);
+	int fd = open(s_appListSnapshotFile, O_RDONLY);
+	if (fd < 0)
+		return;
+
+	struct stat st;
+	if (fstat(fd, &st) < 0 || st.st_size == 0)
+	{
+		close(fd);
+		return;
+	}
+
+	size_t size = st.st_size;
+	void* map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+	{
+		LOG_DEBUG("Unable to map AppList snapshot in %s", __PRETTY_FUNCTION__);
+		return;
+	}
+
+	const char* data = static_cast<const char*>(map);
+	const char* end = data + size;
+	size_t headerLength = strlen(APPLIST_SNAPSHOT_HEADER);
+
+	if (size < headerLength || memcmp(data, APPLIST_SNAPSHOT_HEADER, headerLength) != 0)
+	{
+		LOG_DEBUG("Ignoring AppList snapshot with unknown format in %s", __PRETTY_FUNCTION__);
+		munmap(map, size);
+		return;
+	}
+
+	// One "<id>\t<icon>\n" line per app
+	const char* line = data + headerLength;
+	while (line < end)
+	{
+		const char* eol = static_cast<const char*>(memchr(line, '\n', end - line));
+		if (!eol)
 			break;
-        }
-     }
+
+		const char* tab = static_cast<const char*>(memchr(line, '\t', eol - line));
+		if (tab && tab != line)
+		{
+			AppInfo& appInfo = m_applist[std::string(line, tab)];
+			appInfo.icon.assign(tab + 1, eol);
+			appInfo.generation = m_generation;
+			IconCache::instance().prewarm(appInfo.icon);
+		}
+
+		line = eol + 1;
+	}
+
+	munmap(map, size);
+	m_revision++;
+	LOG_DEBUG("AppList snapshot loaded: %zu apps", m_applist.size());
+}
+
+void AppList::saveSnapshot()
+{
+	std::string contents = APPLIST_SNAPSHOT_HEADER;
+	for (const auto& app : m_applist)
+	{
+		// ids and paths never contain these, skip anything that would break the format
+		if (app.first.find_first_of("\t\n") != std::string::npos ||
+		    app.second.icon.find('\n') != std::string::npos)
+			continue;
+
+		contents += app.first;
+		contents += '\t';
+		contents += app.second.icon;
+		contents += '\n';
+	}
+
+	gchar* dir = g_path_get_dirname(s_appListSnapshotFile);
+	g_mkdir_with_parents(dir, 0755);
+	g_free(dir);
+
+	// Write aside and rename so a crash never leaves a partial snapshot
+	std::string tmpFile = std::string(s_appListSnapshotFile) + ".tmp";
+	FILE* fp = fopen(tmpFile.c_str(), "w");
+	if (!fp)
+	{
+		LOG_WARNING(MSGID_NOTIFICATIONMGR, 0, "Unable to write AppList snapshot in %s", __PRETTY_FUNCTION__);
+		return;
+	}
+
+	bool written = fwrite(contents.data(), 1, contents.size(), fp) == contents.size();
+	written = (fclose(fp) == 0) && written;
+
+	if (!written || rename(tmpFile.c_str(), s_appListSnapshotFile) != 0)
+	{
+		LOG_WARNING(MSGID_NOTIFICATIONMGR, 0, "Unable to write AppList snapshot in %s", __PRETTY_FUNCTION__);
+		unlink(tmpFile.c_str());
+	}
+}
+
+void AppList::scheduleSnapshot()
+{
+	// Installs and full listApps replies come in bursts, write once they settle
+	if (!m_snapshotTimer)
+		m_snapshotTimer = g_timeout_add(APPLIST_SNAPSHOT_DELAY_MS, AppList::cbSaveSnapshot, this);
 }
 
-void AppList::removeAllList()
+gboolean AppList::cbSaveSnapshot(gpointer data)
 {
-	m_applist.clear();
+	AppList* appList = static_cast<AppList*>(data);
+	appList->m_snapshotTimer = 0;
+	appList->saveSnapshot();
+	return G_SOURCE_REMOVE;
 }
@@ -19,9 +19,10 @@
 
 #include <string>
 #include <stdlib.h>
+#include <glib.h>
 #include <luna-service2/lunaservice.h>
 #include <pbnjson.hpp>
-#include <list>
+#include <unordered_map>
 
 class AppList {
 
@@ -34,8 +35,12 @@ public:
 	static bool cbAppMgrAppList(LSHandle* lshandle, LSMessage *message, void *user_data);
 	static bool cbAppMgrGetAppInfo(LSHandle* lshandle, LSMessage *message, void *user_data);
 
+	//! One hash lookup for both existence and icon, icon is left untouched if id is unknown
+	bool lookup(const std::string& id, std::string* icon = NULL) const;
 	bool isAppExist(const std::string& id);
 	std::string getIcon(const std::string& id);
+	//! Bumped whenever an app is added, removed or gets a new icon
+	unsigned int revision() const { return m_revision; }
 
 private:
 	void handleAppResponse(const std::string& change, pbnjson::JValue app);
@@ -43,16 +48,26 @@ private:
 	void addToList(const std::string& id, const std::string& icon);
 	void updateFromList(const std::string& id, const std::string& icon);
 	void removeFromList(const std::string& id);
-	void removeAllList();
+	void sweepList();
+
+	void loadSnapshot();
+	void saveSnapshot();
+	void scheduleSnapshot();
+	static gboolean cbSaveSnapshot(gpointer data);
 
 	void init();
 
 private:
 	struct AppInfo {
-		std::string appId;
 		std::string icon;
+		unsigned int generation;
 	};
-	std::list<AppInfo> m_applist;
+	// keyed by app id
+	std::unordered_map<std::string, AppInfo> m_applist;
+	// bumped on every full listApps reply, apps not seen in it are swept
+	unsigned int m_generation;
+	unsigned int m_revision;
+	guint m_snapshotTimer;
 };
 
 #endif
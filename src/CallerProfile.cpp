@@ -0,0 +1,212 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "CallerProfile.h"
+#include "AppList.h"
+#include "LSUtils.h"
+#include "Settings.h"
+#include "Utils.h"
+
+#include <deque>
+#include <algorithm>
+
+#define CALLER_PROFILE_MAX_ENTRIES 1024
+
+#define MATCH_PRIVILEGED        (1 << 0)
+#define MATCH_AGGREGATOR        (1 << 1)
+#define MATCH_SYSTEM_UI         (1 << 2)
+#define MATCH_SURFACE_MANAGER   (1 << 3)
+
+#define SYSTEM_UI_SOURCE "com.webos.surfacemanager"
+#define SYSTEM_UI_NOTI "com.webos.app.notification"
+
+// Same prefixes as Settings::isPrivilegedSource()
+static const char* const s_privilegedPrefixes[] = { "com.palm.", "com.webos.", "com.lge." };
+
+CallerProfile::CallerProfile()
+    : privileged(false)
+    , aggregator(false)
+    , systemUi(false)
+    , surfaceManager(false)
+    , appExist(false)
+    , appListRevision(0)
+{
+}
+
+int CallerProfiles::Matcher::child(int node, unsigned char c) const
+{
+    for (const auto& next : m_nodes[node].next)
+    {
+        if (next.first == c)
+            return next.second;
+    }
+    return -1;
+}
+
+void CallerProfiles::Matcher::add(const std::string& pattern, unsigned int mask)
+{
+    if (m_nodes.empty())
+        m_nodes.push_back(Node{ {}, 0, 0 });
+
+    int node = 0;
+    for (unsigned char c : pattern)
+    {
+        int next = child(node, c);
+        if (next < 0)
+        {
+            next = m_nodes.size();
+            m_nodes[node].next.push_back(std::make_pair(c, next));
+            m_nodes.push_back(Node{ {}, 0, 0 });
+        }
+        node = next;
+    }
+
+    // An empty pattern lands on the root and so matches any text, like find("")
+    m_nodes[node].out |= mask;
+}
+
+void CallerProfiles::Matcher::build()
+{
+    if (m_nodes.empty())
+        return;
+
+    // Breadth first, so a node's fail link is final before its children use it
+    std::deque<int> queue;
+    for (const auto& next : m_nodes[0].next)
+    {
+        m_nodes[next.second].fail = 0;
+        queue.push_back(next.second);
+    }
+
+    while (!queue.empty())
+    {
+        int node = queue.front();
+        queue.pop_front();
+
+        for (const auto& next : m_nodes[node].next)
+        {
+            int fail = m_nodes[node].fail;
+            while (fail && child(fail, next.first) < 0)
+                fail = m_nodes[fail].fail;
+
+            int target = child(fail, next.first);
+            m_nodes[next.second].fail = (target >= 0 && target != next.second) ? target : 0;
+            m_nodes[next.second].out |= m_nodes[m_nodes[next.second].fail].out;
+            queue.push_back(next.second);
+        }
+    }
+}
+
+unsigned int CallerProfiles::Matcher::match(const std::string& text) const
+{
+    if (m_nodes.empty())
+        return 0;
+
+    unsigned int found = m_nodes[0].out;
+    int node = 0;
+    for (unsigned char c : text)
+    {
+        int next;
+        while ((next = child(node, c)) < 0 && node)
+            node = m_nodes[node].fail;
+        node = next < 0 ? 0 : next;
+        found |= m_nodes[node].out;
+    }
+    return found;
+}
+
+CallerProfiles::CallerProfiles()
+    : m_settingsRevision(0)
+    , m_hits(0)
+    , m_misses(0)
+{
+}
+
+void CallerProfiles::rebuild()
+{
+    m_profiles.clear();
+    m_matcher.clear();
+
+    for (const char* prefix : s_privilegedPrefixes)
+        m_matcher.add(prefix, MATCH_PRIVILEGED);
+    for (const auto& aggregator : Settings::instance()->getAggregators())
+        m_matcher.add(aggregator, MATCH_AGGREGATOR);
+    m_matcher.add(SYSTEM_UI_SOURCE, MATCH_SYSTEM_UI | MATCH_SURFACE_MANAGER);
+    m_matcher.add(SYSTEM_UI_NOTI, MATCH_SYSTEM_UI);
+    m_matcher.build();
+
+    m_settingsRevision = Settings::instance()->revision();
+}
+
+void CallerProfiles::loadApp(CallerProfile& profile)
+{
+    profile.appIcon.clear();
+    profile.appExist = AppList::instance()->lookup(profile.sourceId, &profile.appIcon);
+    profile.appListRevision = AppList::instance()->revision();
+}
+
+const CallerProfile& CallerProfiles::lookup(LSMessage* msg)
+{
+    return lookup(LSUtils::getCallerId(msg));
+}
+
+const CallerProfile& CallerProfiles::lookup(const std::string& callerId)
+{
+    if (callerId.empty())
+        return m_anonymous;
+
+    if (m_matcher.empty() || m_settingsRevision != Settings::instance()->revision())
+        rebuild();
+
+    auto it = m_profiles.find(callerId);
+    if (it != m_profiles.end())
+    {
+        m_hits++;
+        if (it->second.appListRevision != AppList::instance()->revision())
+            loadApp(it->second);
+        return it->second;
+    }
+
+    m_misses++;
+    if (m_profiles.size() >= CALLER_PROFILE_MAX_ENTRIES)
+        m_profiles.clear();
+
+    CallerProfile& profile = m_profiles[callerId];
+    profile.callerId = callerId;
+    profile.sourceId = Utils::extractSourceIdFromCaller(callerId);
+
+    // Privilege and aggregators are checked on the caller id, the system UI
+    // on the source id, as the handlers always did
+    unsigned int callerMatch = m_matcher.match(callerId);
+    unsigned int sourceMatch = (profile.sourceId == callerId) ? callerMatch : m_matcher.match(profile.sourceId);
+
+    profile.privileged = callerMatch & MATCH_PRIVILEGED;
+    profile.aggregator = callerMatch & MATCH_AGGREGATOR;
+    profile.systemUi = sourceMatch & MATCH_SYSTEM_UI;
+    profile.surfaceManager = sourceMatch & MATCH_SURFACE_MANAGER;
+
+    loadApp(profile);
+    return profile;
+}
+
+pbnjson::JValue CallerProfiles::stats() const
+{
+    pbnjson::JValue json = pbnjson::Object();
+    json.put("hits", static_cast<int64_t>(m_hits));
+    json.put("misses", static_cast<int64_t>(m_misses));
+    json.put("entries", static_cast<int64_t>(m_profiles.size()));
+    return json;
+}
@@ -0,0 +1,105 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __CALLERPROFILE_H__
+#define __CALLERPROFILE_H__
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <luna-service2/lunaservice.h>
+#include <pbnjson.hpp>
+
+#include "Singleton.hpp"
+
+//! What a request handler needs to know about its caller
+struct CallerProfile
+{
+    CallerProfile();
+
+    std::string callerId;       // empty if the message has no sender
+    std::string sourceId;       // callerId up to its last blank
+    bool privileged;            // com.palm., com.webos. or com.lge. caller
+    bool aggregator;            // matches a NotificationAggregator of the settings
+    bool systemUi;              // surface manager or the notification app
+    bool surfaceManager;
+
+    bool appExist;              // sourceId is an installed app
+    std::string appIcon;        // its icon, empty if it has none
+
+    bool trusted() const { return privileged || aggregator; }
+
+private:
+    friend class CallerProfiles;
+    unsigned int appListRevision;
+};
+
+/*! Caches a CallerProfile per caller id, so the privilege and aggregator
+ * substring checks run once per caller instead of once per request. All
+ * patterns are matched in a single pass with an Aho-Corasick automaton,
+ * with the same substring semantics as Settings::isPrivilegedSource() and
+ * Settings::isPartOfAggregators(). Profiles are dropped when the settings
+ * are reloaded; the app fields follow AppList changes.
+ */
+class CallerProfiles : public Singleton<CallerProfiles>
+{
+public:
+    CallerProfiles();
+
+    /*! Profile of the sender of msg, identified like LSUtils::getCallerId().
+     * The reference stays valid until the next lookup.
+     */
+    const CallerProfile& lookup(LSMessage* msg);
+    const CallerProfile& lookup(const std::string& callerId);
+
+    pbnjson::JValue stats() const;
+
+private:
+    class Matcher
+    {
+    public:
+        void add(const std::string& pattern, unsigned int mask);
+        void build();
+        //! Masks of all patterns found in text
+        unsigned int match(const std::string& text) const;
+        void clear() { m_nodes.clear(); }
+        bool empty() const { return m_nodes.empty(); }
+
+    private:
+        struct Node {
+            std::vector< std::pair<unsigned char, int> > next;
+            int fail;
+            unsigned int out;
+        };
+
+        int child(int node, unsigned char c) const;
+
+        std::vector<Node> m_nodes;
+    };
+
+    void rebuild();
+    void loadApp(CallerProfile& profile);
+
+    std::unordered_map<std::string, CallerProfile> m_profiles;
+    CallerProfile m_anonymous;
+    Matcher m_matcher;
+    unsigned int m_settingsRevision;
+
+    unsigned long m_hits;
+    unsigned long m_misses;
+};
+
+#endif
@@ -0,0 +1,320 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "DbJournal.h"
+#include "NotificationService.h"
+#include "LSUtils.h"
+#include "JUtil.h"
+#include "Logging.h"
+
+#define JOURNAL_FLUSH_INTERVAL_MS 200
+#define JOURNAL_MAX_PENDING_OPS 64
+
+// Every history record has a unique timestamp, see Utils::createTimestamp
+#define JOURNAL_UNIQUE_KEY "timestamp"
+
+DbJournal::DbJournal()
+    : m_timer(0)
+{
+}
+
+DbJournal::~DbJournal()
+{
+    if (m_timer)
+        g_source_remove(m_timer);
+
+    // Their replies may still arrive
+    for (Batch* batch : m_batches)
+        batch->journal = NULL;
+}
+
+static void appendOperation(std::string &operations, const std::string &operation)
+{
+    if (!operations.empty())
+        operations += ',';
+    operations += operation;
+}
+
+void DbJournal::put(pbnjson::JValue object, std::string serialized)
+{
+    Op op;
+    op.type = OP_PUT;
+    op.retried = false;
+    op.object = std::move(object);
+    op.serialized = std::move(serialized);
+    m_ops.push_back(std::move(op));
+
+    schedule();
+}
+
+void DbJournal::del(pbnjson::JValue query)
+{
+    bool droppedPut = false;
+    std::string queryString = JUtil::jsonToString(query);
+
+    for (auto it = m_ops.begin(); it != m_ops.end(); )
+    {
+        if (it->type == OP_PUT && matches(it->object, query))
+        {
+            it = m_ops.erase(it);
+            droppedPut = true;
+        }
+        else if (it->type == OP_MERGE && JUtil::jsonToString(it->query) == queryString)
+        {
+            it = m_ops.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    // The record only lived in the journal, so db8 has nothing to delete.
+    if (droppedPut && isUniqueKeyQuery(query))
+    {
+        LOG_DEBUG("[DbJournal] put/del pair dropped before flush");
+        return;
+    }
+
+    Op op;
+    op.type = OP_DEL;
+    op.retried = false;
+    op.query = std::move(query);
+    m_ops.push_back(std::move(op));
+
+    schedule();
+}
+
+void DbJournal::merge(pbnjson::JValue query, pbnjson::JValue props)
+{
+    // Fold into a pending put of the same record
+    for (auto &op : m_ops)
+    {
+        if (op.type == OP_PUT && isUniqueKeyQuery(query) && matches(op.object, query))
+        {
+            for (auto prop : props.children())
+                op.object.put(prop.first.asString(), prop.second);
+            op.serialized.clear();
+            return;
+        }
+    }
+
+    // Collapse with the trailing merges of the same query
+    std::string queryString = JUtil::jsonToString(query);
+    for (auto it = m_ops.rbegin(); it != m_ops.rend() && it->type == OP_MERGE; ++it)
+    {
+        if (JUtil::jsonToString(it->query) == queryString)
+        {
+            for (auto prop : props.children())
+                it->props.put(prop.first.asString(), prop.second);
+            return;
+        }
+    }
+
+    Op op;
+    op.type = OP_MERGE;
+    op.retried = false;
+    op.query = std::move(query);
+    op.props = std::move(props);
+    m_ops.push_back(std::move(op));
+
+    schedule();
+}
+
+void DbJournal::flush()
+{
+    if (m_timer)
+    {
+        g_source_remove(m_timer);
+        m_timer = 0;
+    }
+
+    if (m_ops.empty())
+        return;
+
+    LOG_DEBUG("[DbJournal] flush %zu operations", m_ops.size());
+
+    Batch* batch = new Batch{ this, std::deque<Op>() };
+    batch->ops.swap(m_ops);
+    send(batch);
+}
+
+std::string DbJournal::payload(std::deque<Op>& ops)
+{
+    // Built as text so that pre-serialized objects are copied in as they are
+    std::string operations;
+    std::string objects;
+
+    for (auto &op : ops)
+    {
+        if (op.type == OP_PUT)
+        {
+            // consecutive puts share one operation
+            if (!objects.empty())
+                objects += ',';
+            if (op.serialized.empty())
+                op.serialized = JUtil::jsonToString(op.object);
+            objects += op.serialized;
+            continue;
+        }
+
+        if (!objects.empty())
+        {
+            appendOperation(operations, "{\"method\":\"put\",\"params\":{\"objects\":[" + objects + "]}}");
+            objects.clear();
+        }
+
+        if (op.type == OP_DEL)
+        {
+            appendOperation(operations, JUtil::jsonToString(pbnjson::JObject{{"method", "del"},
+                                               {"params", pbnjson::JObject{{"query", op.query}, {"purge", true}}}}));
+        }
+        else
+        {
+            appendOperation(operations, JUtil::jsonToString(pbnjson::JObject{{"method", "merge"},
+                                               {"params", pbnjson::JObject{{"query", op.query}, {"props", op.props}}}}));
+        }
+    }
+
+    if (!objects.empty())
+        appendOperation(operations, "{\"method\":\"put\",\"params\":{\"objects\":[" + objects + "]}}");
+
+    return "{\"operations\":[" + operations + "]}";
+}
+
+void DbJournal::send(Batch* batch)
+{
+    std::string payload = DbJournal::payload(batch->ops);
+
+    LSErrorSafe lserror;
+    if (LSCallOneReply(NotificationService::instance()->getHandle(), "palm://com.palm.db/batch",
+                       payload.c_str(),
+                       DbJournal::cbBatch, batch, NULL, &lserror) == false)
+    {
+        LOG_WARNING(MSGID_SAVE_MSG_FAIL, 0, "Batch write to History table call failed in %s", __PRETTY_FUNCTION__ );
+        failed(batch);
+        return;
+    }
+
+    m_batches.insert(batch);
+}
+
+bool DbJournal::cbBatch(LSHandle* lshandle, LSMessage *message, void *user_data)
+{
+    Batch* batch = static_cast<Batch*>(user_data);
+    DbJournal* journal = batch->journal;
+
+    pbnjson::JValue response = JUtil::parse(LSMessageGetPayload(message), "", nullptr);
+    bool success = !response.isNull() && response["returnValue"].asBool();
+
+    if (!journal)
+    {
+        delete batch;
+        return true;
+    }
+
+    journal->m_batches.erase(batch);
+    if (success)
+    {
+        delete batch;
+        return true;
+    }
+
+    LOG_WARNING(MSGID_DB8_CALL_FAILED, 2,
+                PMLOGKFV("OPERATIONS", "%zu", batch->ops.size()),
+                PMLOGKS("ERROR", response["errorText"].asString().c_str()),
+                "Batch write to History table failed in %s", __PRETTY_FUNCTION__);
+    journal->failed(batch);
+    return true;
+}
+
+void DbJournal::failed(Batch* batch)
+{
+    // db8 applies a batch as a whole, so none of it was written. Send each
+    // operation again on its own, in the same order and so still ahead of
+    // the operations queued since; those are flushed later.
+    if (batch->ops.size() > 1 || !batch->ops.front().retried)
+    {
+        std::deque<Op> ops;
+        ops.swap(batch->ops);
+        delete batch;
+
+        for (auto &op : ops)
+        {
+            op.retried = true;
+            Batch* single = new Batch{ this, std::deque<Op>() };
+            single->ops.push_back(std::move(op));
+            send(single);
+        }
+        return;
+    }
+
+    static const char* const methods[] = { "put", "del", "merge" };
+    LOG_WARNING(MSGID_SAVE_MSG_FAIL, 1,
+                PMLOGKS("METHOD", methods[batch->ops.front().type]),
+                "History operation failed on its own too and is lost");
+    delete batch;
+
+    sigLost(1);
+}
+
+void DbJournal::schedule()
+{
+    if (m_ops.size() >= JOURNAL_MAX_PENDING_OPS)
+    {
+        flush();
+        return;
+    }
+
+    if (!m_timer)
+        m_timer = g_timeout_add(JOURNAL_FLUSH_INTERVAL_MS, DbJournal::cbFlush, this);
+}
+
+bool DbJournal::matches(const pbnjson::JValue &object, const pbnjson::JValue &query)
+{
+    pbnjson::JValue where = query["where"];
+    if (!where.isArray() || where.arraySize() == 0)
+        return false;
+
+    for (ssize_t index = 0; index < where.arraySize(); ++index)
+    {
+        // Only top-level equality can be evaluated here
+        std::string prop = where[index]["prop"].asString();
+        if (where[index]["op"].asString() != "=" || prop.find('.') != std::string::npos)
+            return false;
+
+        if (!object.hasKey(prop) || object[prop] != where[index]["val"])
+            return false;
+    }
+
+    return true;
+}
+
+bool DbJournal::isUniqueKeyQuery(const pbnjson::JValue &query)
+{
+    pbnjson::JValue where = query["where"];
+    return where.isArray() && where.arraySize() == 1 &&
+           where[0]["prop"].asString() == JOURNAL_UNIQUE_KEY &&
+           where[0]["op"].asString() == "=";
+}
+
+gboolean DbJournal::cbFlush(gpointer data)
+{
+    DbJournal *journal = static_cast<DbJournal*>(data);
+    journal->m_timer = 0;
+    journal->flush();
+    return G_SOURCE_REMOVE;
+}
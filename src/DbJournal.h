@@ -0,0 +1,103 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __DBJOURNAL_H__
+#define __DBJOURNAL_H__
+
+#include <deque>
+#include <set>
+#include <string>
+#include <glib.h>
+#include <luna-service2/lunaservice.h>
+#include <pbnjson.hpp>
+#include <boost/signals2.hpp>
+
+/*! Write-behind queue for db8 history writes.
+ * put/del/merge calls are collected and sent as one db8 batch call when the
+ * flush timer fires or too many operations are pending. Operations which
+ * are superseded before the flush (e.g. a put followed by a delete of the
+ * same record) are dropped without ever reaching db8. When db8 fails a
+ * batch, each of its operations is sent again in a batch of its own, so
+ * one bad operation can't take the others down with it. Operations which
+ * fail on their own too are reported by sigLost.
+ */
+class DbJournal
+{
+public:
+    DbJournal();
+    ~DbJournal();
+
+    /*! Queue an object to be stored. _kind must already be set.
+     * serialized may hold object already serialized, it is sent as is.
+     */
+    void put(pbnjson::JValue object, std::string serialized = std::string());
+
+    //! Queue a purge of every record matching query
+    void del(pbnjson::JValue query);
+
+    //! Queue a merge of props into every record matching query
+    void merge(pbnjson::JValue query, pbnjson::JValue props);
+
+    //! Send every pending operation to db8 now
+    void flush();
+
+    size_t pending() const { return m_ops.size(); }
+    //! Nothing queued and no batch waiting for db8, which then has every write
+    bool idle() const { return m_ops.empty() && m_batches.empty(); }
+
+    /*! Operations were refused by db8 even on their own. Whatever was
+     * already applied from them elsewhere no longer matches db8.
+     */
+    boost::signals2::signal<void (size_t lost)> sigLost;
+
+private:
+    enum OpType {
+        OP_PUT,
+        OP_DEL,
+        OP_MERGE
+    };
+
+    struct Op {
+        OpType type;
+        pbnjson::JValue object;
+        std::string serialized;     // object as JSON, empty if not generated yet
+        pbnjson::JValue query;
+        pbnjson::JValue props;
+        bool retried;               // sent on its own after its batch failed
+    };
+
+    //! Operations sent in one db8 batch call, until its reply
+    struct Batch {
+        DbJournal* journal;         // NULL once the journal is gone
+        std::deque<Op> ops;
+    };
+
+    void schedule();
+    void send(Batch* batch);
+    static std::string payload(std::deque<Op>& ops);
+
+    static bool matches(const pbnjson::JValue &object, const pbnjson::JValue &query);
+    static bool isUniqueKeyQuery(const pbnjson::JValue &query);
+    static gboolean cbFlush(gpointer data);
+    static bool cbBatch(LSHandle* lshandle, LSMessage* message, void* user_data);
+    void failed(Batch* batch);
+
+    std::deque<Op> m_ops;
+    guint m_timer;
+    std::set<Batch*> m_batches;     // in flight
+};
+
+#endif
@@ -0,0 +1,77 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "DisplayState.h"
+#include "Settings.h"
+#include "Utils.h"
+
+DisplayState::DisplayState()
+    : readCount(0)
+    , unreadCount(0)
+    , subscribers(0)
+    , toasts(0)
+    , countSequence(0)
+{
+}
+
+bool DisplayTable::isValid(int displayId)
+{
+    return displayId >= 0 && static_cast<size_t>(displayId) < Settings::instance()->getMaxDisplays();
+}
+
+std::string DisplayTable::invalidText()
+{
+    return "Invalid displayId. Must be 0 to " + Utils::toString(Settings::instance()->getMaxDisplays() - 1);
+}
+
+DisplayState* DisplayTable::get(int displayId)
+{
+    if (!isValid(displayId))
+        return NULL;
+
+    // A deque keeps the existing entries in place while growing
+    if (static_cast<size_t>(displayId) >= m_displays.size())
+        m_displays.resize(displayId + 1);
+    return &m_displays[displayId];
+}
+
+const DisplayState* DisplayTable::find(int displayId) const
+{
+    if (displayId < 0 || static_cast<size_t>(displayId) >= m_displays.size())
+        return NULL;
+    return &m_displays[displayId];
+}
+
+pbnjson::JValue DisplayTable::stats() const
+{
+    pbnjson::JValue displays = pbnjson::Array();
+    for (size_t displayId = 0; displayId < m_displays.size(); ++displayId)
+    {
+        const DisplayState& display = m_displays[displayId];
+        pbnjson::JValue json = pbnjson::Object();
+        json.put("displayId", static_cast<int>(displayId));
+        json.put("readCount", display.readCount);
+        json.put("unreadCount", display.unreadCount);
+        json.put("ready", display.ready());
+        json.put("toasts", static_cast<int64_t>(display.toasts));
+        displays.append(json);
+    }
+
+    pbnjson::JValue json = pbnjson::Object();
+    json.put("maxDisplays", static_cast<int64_t>(Settings::instance()->getMaxDisplays()));
+    json.put("displays", displays);
+    return json;
+}
@@ -0,0 +1,65 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __DISPLAYSTATE_H__
+#define __DISPLAYSTATE_H__
+
+#include <deque>
+#include <string>
+#include <pbnjson.hpp>
+
+#include "Singleton.hpp"
+
+//! What the service tracks for each display
+struct DisplayState
+{
+    DisplayState();
+
+    int readCount;              // toasts in the history, kept by ToastCounter
+    int unreadCount;
+    unsigned int subscribers;   // System UI getToastCount subscriptions
+    unsigned long toasts;       // toasts created since startup
+    unsigned long countSequence;    // of the last getToastCount post
+
+    int totalCount() const { return readCount + unreadCount; }
+    //! A System UI is showing this display
+    bool ready() const { return subscribers > 0; }
+};
+
+/*! Per-display state indexed by displayId. Entries are created on first
+ * use up to the MaxDisplays setting, so builds with more screens need no
+ * code change, and stay at the same address once created.
+ */
+class DisplayTable : public Singleton<DisplayTable>
+{
+public:
+    //! State of displayId, created if needed. NULL if displayId is out of range.
+    DisplayState* get(int displayId);
+    //! State of displayId, NULL if it was never used or is out of range
+    const DisplayState* find(int displayId) const;
+
+    //! True if displayId is in [0, MaxDisplays)
+    static bool isValid(int displayId);
+    //! Message for requests with an invalid displayId
+    static std::string invalidText();
+
+    pbnjson::JValue stats() const;
+
+private:
+    std::deque<DisplayState> m_displays;
+};
+
+#endif
@@ -0,0 +1,143 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "FileWatcher.h"
+#include "Logging.h"
+
+#include <unistd.h>
+#include <sys/inotify.h>
+
+#define FILE_WATCHER_MASK (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE | \
+                           IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF)
+
+FileWatcher::FileWatcher()
+    : m_source(0)
+{
+    m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_fd < 0)
+    {
+        LOG_WARNING(MSGID_NOTIFICATIONMGR, 0, "inotify is not available in %s", __PRETTY_FUNCTION__);
+        return;
+    }
+
+    GIOChannel* channel = g_io_channel_unix_new(m_fd);
+    m_source = g_io_add_watch(channel, G_IO_IN, FileWatcher::cbInotify, this);
+    g_io_channel_unref(channel);
+}
+
+FileWatcher::~FileWatcher()
+{
+    if (m_source)
+        g_source_remove(m_source);
+    if (m_fd >= 0)
+        close(m_fd);
+}
+
+bool FileWatcher::watch(const std::string& dir)
+{
+    if (m_fd < 0)
+        return false;
+
+    if (isWatched(dir))
+        return true;
+
+    int wd = inotify_add_watch(m_fd, dir.c_str(), FILE_WATCHER_MASK | IN_ONLYDIR);
+    if (wd < 0)
+        return false;
+
+    m_dirs[wd] = dir;
+    m_watches[dir] = wd;
+    return true;
+}
+
+void FileWatcher::unwatch(const std::string& dir)
+{
+    auto it = m_watches.find(dir);
+    if (it == m_watches.end())
+        return;
+
+    inotify_rm_watch(m_fd, it->second);
+    m_dirs.erase(it->second);
+    m_watches.erase(it);
+}
+
+bool FileWatcher::isWatched(const std::string& dir) const
+{
+    return m_watches.count(dir) != 0;
+}
+
+gboolean FileWatcher::cbInotify(GIOChannel* channel, GIOCondition condition, gpointer data)
+{
+    FileWatcher* watcher = static_cast<FileWatcher*>(data);
+
+    char buf[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+
+    while (true)
+    {
+        ssize_t len = read(watcher->m_fd, buf, sizeof(buf));
+        if (len <= 0)
+            break;
+
+        for (char* ptr = buf; ptr < buf + len; )
+        {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(ptr);
+            ptr += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                LOG_DEBUG("[FileWatcher] event queue overflow");
+                watcher->sigChanged("", "");
+                continue;
+            }
+
+            auto it = watcher->m_dirs.find(event->wd);
+            if (it == watcher->m_dirs.end())
+                continue;
+
+            // Copy, the entry may be dropped below
+            std::string dir = it->second;
+
+            if (event->mask & IN_IGNORED)
+            {
+                watcher->m_watches.erase(dir);
+                watcher->m_dirs.erase(it);
+                watcher->sigChanged(dir, "");
+                continue;
+            }
+
+            // The watch follows the moved directory, not the path; drop it so
+            // that a directory created at the path can be watched again
+            if (event->mask & IN_MOVE_SELF)
+            {
+                inotify_rm_watch(watcher->m_fd, event->wd);
+                watcher->m_watches.erase(dir);
+                watcher->m_dirs.erase(it);
+                watcher->sigChanged(dir, "");
+                continue;
+            }
+
+            if (event->mask & IN_DELETE_SELF)
+            {
+                watcher->sigChanged(dir, "");
+                continue;
+            }
+
+            watcher->sigChanged(dir, event->len ? std::string(event->name) : std::string());
+        }
+    }
+
+    return G_SOURCE_CONTINUE;
+}
@@ -0,0 +1,56 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __FILEWATCHER_H__
+#define __FILEWATCHER_H__
+
+#include <string>
+#include <unordered_map>
+#include <glib.h>
+#include <boost/signals2.hpp>
+
+#include "Singleton.hpp"
+
+/*! inotify based directory watcher dispatched from the main loop.
+ * sigChanged(dir, name) is emitted when an entry of a watched directory is
+ * created, deleted, moved or rewritten. name is empty when the directory
+ * itself went away, after which it is no longer watched, and both are empty when the kernel dropped events, in
+ * which case listeners should assume anything may have changed.
+ */
+class FileWatcher : public Singleton<FileWatcher>
+{
+public:
+    FileWatcher();
+    ~FileWatcher();
+
+    //! Watch dir, returns false if it does not exist or can't be watched
+    bool watch(const std::string& dir);
+    void unwatch(const std::string& dir);
+    bool isWatched(const std::string& dir) const;
+    size_t count() const { return m_dirs.size(); }
+
+    boost::signals2::signal<void (const std::string&, const std::string&)> sigChanged;
+
+private:
+    static gboolean cbInotify(GIOChannel* channel, GIOCondition condition, gpointer data);
+
+    int m_fd;
+    guint m_source;
+    std::unordered_map<int, std::string> m_dirs;
+    std::unordered_map<std::string, int> m_watches;
+};
+
+#endif
@@ -22,29 +22,76 @@
 #include "Logging.h"
 #include "SystemTime.h"
 #include <string>
+#include <algorithm>
 #include <pbnjson.hpp>
 
 #define DB8_KIND "com.webos.notificationhistory:1"
 
 #define MAX_TIMESTAMP 253402300799
 
+#define HISTORY_QUERY_TIMEOUT_MS 10000
+#define HISTORY_QUERY_SWEEP_MS 1000
+#define HISTORY_QUERY_POOL_SIZE 8
+
+// Longest wait for an expiry, GLib timers don't follow the wall clock while suspended
+#define HISTORY_EXPIRE_MAX_WAIT_S 3600
+
 static History* s_history_instance = 0;
 
 using namespace std::placeholders;
 
+static std::string findPayload(pbnjson::JValue query, int limit, const std::string& page)
+{
+    if (limit > 0)
+        query.put("limit", limit);
+    if (!page.empty())
+        query.put("page", page);
+
+    pbnjson::JValue find_query = pbnjson::Object();
+    find_query.put("query", query);
+    return JUtil::jsonToString(std::move(find_query));
+}
+
 History::History()
     : m_expireData(false)
+    , m_expireTimer(0)
+    , m_expireAt(0)
+    , m_reloadIndex(false)
+    , m_queryTimer(0)
 {
     s_history_instance = this;
 
     m_connSystemTimeSync = SystemTime::instance().sigSync.connect(
         std::bind(&History::onSystemTimeSync, this, _1)
     );
+
+    m_connIndexReady = m_index.sigReady.connect(
+        std::bind(&History::onIndexReady, this)
+    );
+
+    m_connJournalLost = m_journal.sigLost.connect(
+        std::bind(&History::onJournalLost, this, _1)
+    );
+
+    m_index.load(NotificationService::instance()->getHandle(), DB8_KIND);
+    m_counter.start(NotificationService::instance()->getHandle(), DB8_KIND, m_index, m_journal);
 }
 
 History::~History()
 {
+    if (m_queryTimer)
+        g_source_remove(m_queryTimer);
+    if (m_expireTimer)
+        g_source_remove(m_expireTimer);
+
+    for (QueryContext* context : m_queries)
+    {
+        LSMessageUnref(context->reply);
+        delete context;
+    }
 
+    for (QueryContext* context : m_queryPool)
+        delete context;
 }
 
 History* History::instance()
@@ -56,61 +103,91 @@ History* History::instance()
 	return s_history_instance;
 }
 
-void History::saveMessage(pbnjson::JValue msg)
+bool History::hasInstance()
 {
-	LSErrorSafe lserror;
-	pbnjson::JValue objArray = pbnjson::Array();
-	pbnjson::JValue payload = pbnjson::Object();
+    return s_history_instance != 0;
+}
+
+void History::saveMessage(pbnjson::JValue msg, const std::string& body)
+{
+	std::string members = "\"_kind\":\"" DB8_KIND "\"";
 
 	pbnjson::JValue scheduleInMsg = msg["schedule"];
-        if(scheduleInMsg.isNull())
-        {
-         pbnjson::JValue schedule = pbnjson::Object();
-         schedule.put("expire", MAX_TIMESTAMP);
-         msg.put("schedule", schedule);
-        }
+	if(scheduleInMsg.isNull())
+	{
+		pbnjson::JValue schedule = pbnjson::Object();
+		schedule.put("expire", MAX_TIMESTAMP);
+		msg.put("schedule", schedule);
+		members += ",\"schedule\":{\"expire\":" + Utils::toString(MAX_TIMESTAMP) + "}";
+	}
+
+	int64_t expire = msg["schedule"]["expire"].isNumber() ? msg["schedule"]["expire"].asNumber<int64_t>() : 0;
+
+	std::string collapseKey = msg["collapseKey"].asString();
+	if(!collapseKey.empty())
+	{
+		std::string sourceId = msg["sourceId"].asString();
+
+		if(!m_index.isReady())
+		{
+			// Can't tell which record is replaced yet, let db8 find it
+			pbnjson::JValue query = pbnjson::JObject{{"from", DB8_KIND},
+				{"where", pbnjson::JArray{{{"prop", "sourceId"}, {"op", "="}, {"val", sourceId}},
+				                          {{"prop", "collapseKey"}, {"op", "="}, {"val", collapseKey}}}}};
+			applyDel(std::move(query));
+		}
+		else
+		{
+			// Replaced as a whole, even when it keeps the timestamp, so no prop
+			// of the superseded toast survives on the stored record
+			std::string previous = m_index.findCollapsed(sourceId, collapseKey);
+			if(!previous.empty())
+				deleteMessage("timestamp", previous);
+		}
+	}
 
 	//Add kind to the object
 	msg.put("_kind", DB8_KIND);
-	objArray.put(0, msg);
+	m_index.put(msg);
+	m_journal.put(std::move(msg), body.empty() ? body : JUtil::prependMembers(body, members));
+	expiryAdded(expire);
+}
 
-	payload.put("objects", objArray);
-	std::string msgPayload = pbnjson::JGenerator::serialize(payload, pbnjson::JSchemaFragment("{}"));
+std::string History::findCollapsed(const std::string& sourceId, const std::string& collapseKey) const
+{
+    if (!m_index.isReady())
+        return std::string();
+    return m_index.findCollapsed(sourceId, collapseKey);
+}
 
-	if (LSCallOneReply(NotificationService::instance()->getHandle(),"palm://com.palm.db/put",
-							msgPayload.c_str(),
-							History::cbDb8Response,NULL,NULL, &lserror) == false) {
-				 LOG_WARNING(MSGID_SAVE_MSG_FAIL, 0, "Save Message to History table call failed in %s", __PRETTY_FUNCTION__ );
-	}
+void History::applyDel(pbnjson::JValue query)
+{
+    // Rows the index hasn't loaded yet can't be counted out
+    if (!m_index.isReady())
+        m_counter.reconcileSoon();
 
+    m_index.del(query);
+    m_journal.del(std::move(query));
 }
 
-void History::deleteMessage(const std::string &key, const std::string& value)
+void History::applyMerge(pbnjson::JValue query, pbnjson::JValue props)
 {
-    LSErrorSafe lserror;
-
-    std::string query =
-        std::string( R"({"query":{"from":"com.webos.notificationhistory:1","where":[{"prop":")" ) +
-        key +
-        std::string( R"(","op":"=","val":")" ) +
-        value +
-        std::string( R"("}]},"purge":true})" );
+    if (!m_index.isReady())
+        m_counter.reconcileSoon();
 
-    if (LSCallOneReply(NotificationService::instance()->getHandle(),"palm://com.palm.db/del",
-        query.c_str(),
-        History::cbDb8Response,NULL,NULL, &lserror) == false)
-    {
-        LOG_WARNING(MSGID_DEL_MSG_FAIL, 0, "Delete Message from History table call failed in %s", __PRETTY_FUNCTION__ );
-    }
+    m_index.merge(query, props);
+    m_journal.merge(std::move(query), std::move(props));
 }
 
-bool History::selectMessage(LSHandle* lshandle, const std::string& id, LSMessage *message)
+void History::deleteMessage(const std::string &key, const std::string& value)
 {
-    LSErrorSafe lserror;
-
-    LSMessageRef(message);
-    replyMsg = message;
+    pbnjson::JValue query = pbnjson::JObject{{"from", DB8_KIND},
+                                   {"where", pbnjson::JArray{{{"prop", key}, {"op", "="}, {"val", value}}}}};
+    applyDel(std::move(query));
+}
 
+bool History::selectMessage(LSHandle* lshandle, const std::string& id, LSMessage *message, int limit, const std::string& page)
+{
     pbnjson::JValue request;
     JUtil::Error error;
 
@@ -121,35 +198,29 @@ bool History::selectMessage(LSHandle* lshandle, const std::string& id, LSMessage
         return false;
     }
 
-    gchar* query = NULL;
+    pbnjson::JValue query;
 
     if(id == "all")
     {
-        query = g_strdup_printf ("{\"query\":{\"from\":\"com.webos.notificationhistory:1\", \"where\":[{\"prop\":\"saveRemoteNotification\", \"op\":\"=\", \"val\":false}]}}");
+        query = pbnjson::JObject{{"from", DB8_KIND},
+                                 {"where", pbnjson::JArray{{{"prop", "saveRemoteNotification"}, {"op", "="}, {"val", false}}}}};
     }
     else
     {
-        query = g_strdup_printf ("{\"query\":{\"from\":\"com.webos.notificationhistory:1\", \"where\":[{\"prop\":\"sourceId\", \"op\":\"=\", \"val\":\"%s\"}]}}", id.c_str());
+        query = pbnjson::JObject{{"from", DB8_KIND},
+                                 {"where", pbnjson::JArray{{{"prop", "sourceId"}, {"op", "="}, {"val", id}}}}};
     }
 
-    LOG_WARNING(MSGID_NOTIFICATIONMGR, 0, "[%s:%d] query = %s", __FUNCTION__, __LINE__, query);
-    if (LSCallOneReply(lshandle, "palm://com.palm.db/find",
-                query,
-                History::cbDb8getNotiResponse,this,NULL, &lserror) == false) {
-        LOG_WARNING(MSGID_SAVE_MSG_FAIL, 0, "Select Message to History table call failed in %s", __PRETTY_FUNCTION__ );
-    }
-    g_free (query);
-    LOG_WARNING(MSGID_NOTIFICATIONMGR, 0, "[%s:%d]", __FUNCTION__, __LINE__);
-    return true;
+    std::string payload = findPayload(std::move(query), limit, page);
+
+    LOG_WARNING(MSGID_NOTIFICATIONMGR, 0, "[%s:%d] query = %s", __FUNCTION__, __LINE__, payload.c_str());
+    return startQuery(lshandle, message, std::move(request), payload, History::cbDb8getNotiResponse);
 }
 
 bool History::selectToastMessage(LSHandle* lshandle, const std::string& id, LSMessage *message)
 {
     LSErrorSafe lserror;
 
-    LSMessageRef(message);
-    replyMsg = message;
-
     pbnjson::JValue request;
     JUtil::Error error;
 
@@ -160,48 +231,78 @@ bool History::selectToastMessage(LSHandle* lshandle, const std::string& id, LSMe
         return false;
     }
 
-    pbnjson::JValue find_query = pbnjson::JObject();
     int display_id = request["displayId"].asNumber<int>(); //NotificationService::instance()->getDisplayId();
-    pbnjson::JValue toast_request = pbnjson::JObject{{"from", DB8_KIND},
-                                               {"where", pbnjson::JArray{{{"prop", "displayId"}, {"op", "="}, {"val", display_id}}}}};
-    find_query.put("query", toast_request);
-    if (LSCallOneReply(lshandle, "palm://com.palm.db/find",
-                       JUtil::jsonToString(std::move(find_query)).c_str(),
-                       History::cbDb8getToastResponse, this, NULL, &lserror) == false) {
-                       LOG_WARNING(MSGID_SAVE_MSG_FAIL, 0, "Select Message to History table call failed in %s", __PRETTY_FUNCTION__ );
+    int limit = request["limit"].asNumber<int>();
+    std::string page = request["page"].asString();
+    pbnjson::JValue readStatus = request["readStatus"];
+
+    // Pages handed out by the index are resumed from memory, db8 pages from db8
+    if(m_index.isReady() && (page.empty() || ToastIndex::isCursor(page)))
+    {
+        std::vector<pbnjson::JValue> rows;
+        if(!m_index.byDisplay(display_id, readStatus, limit, page, rows))
+        {
+            return false;
+        }
+
+        static JsonWriter writer(4096);
+        writer.clear();
+
+        writer.beginObject().member("returnValue", true);
+        writer.key("toastInfo").beginArray();
+        for (const pbnjson::JValue& row : rows)
+            writeToastInfo(writer, row);
+        writer.endArray();
+        if(!page.empty())
+        {
+            writer.member("next", page);
+        }
+        writer.endObject();
+
+        return LSMessageReply(lshandle, message, writer.c_str(), &lserror);
     }
-    return true;
+
+    if(ToastIndex::isCursor(page))
+    {
+        return false;
+    }
+
+    // The index is still loading, ask db8
+    // Served by the DisplayIdAndReadStatus index when readStatus is given
+    pbnjson::JValue where = pbnjson::JArray{{{"prop", "displayId"}, {"op", "="}, {"val", display_id}}};
+    if(!readStatus.isNull())
+    {
+        where.append(pbnjson::JObject{{"prop", "readStatus"}, {"op", "="}, {"val", readStatus}});
+    }
+
+    std::string payload = findPayload(pbnjson::JObject{{"from", DB8_KIND}, {"where", where}}, limit, page);
+    return startQuery(lshandle, message, std::move(request), payload, History::cbDb8getToastResponse);
 }
 
-bool History::selectRemoteMessage(LSHandle* lshandle, const std::string& id, LSMessage *message)
+bool History::selectRemoteMessage(LSHandle* lshandle, const std::string& id, LSMessage *message, int limit, const std::string& page)
 {
-    LSErrorSafe lserror;
+    pbnjson::JValue request;
+    JUtil::Error error;
 
-    LSMessageRef(message);
-    replyMsg = message;
+    request = JUtil::parse(LSMessageGetPayload(message), "", &error);
 
-    gchar* query = (char *)"";
+    pbnjson::JValue query;
 
     if(id == "all")
     {
-        query = g_strdup_printf ("{\"query\":{\"from\":\"com.webos.notificationhistory:1\", \"where\":[{\"prop\":\"saveRemoteNotification\", \"op\":\"=\", \"val\":true}]}}");
+        query = pbnjson::JObject{{"from", DB8_KIND},
+                                 {"where", pbnjson::JArray{{{"prop", "saveRemoteNotification"}, {"op", "="}, {"val", true}}}}};
     }
     else
     {
-        query = g_strdup_printf ("{\"query\":{\"from\":\"com.webos.notificationhistory:1\", \"where\":[{\"prop\":\"remotePackageName\", \"op\":\"=\", \"val\":\"%s\"}]}}", id.c_str());
+        query = pbnjson::JObject{{"from", DB8_KIND},
+                                 {"where", pbnjson::JArray{{{"prop", "remotePackageName"}, {"op", "="}, {"val", id}}}}};
     }
 
-    LOG_WARNING(MSGID_NOTIFICATIONMGR, 0, "[%s:%d] query = %s", __FUNCTION__, __LINE__, query);
-    if (LSCallOneReply(lshandle, "palm://com.palm.db/find",
-                query,
-                History::cbDb8getRemoteNotiResponse,this,NULL, &lserror) == false) {
-        LOG_WARNING(MSGID_SAVE_MSG_FAIL, 0, "Select Message to History table call failed in %s", __PRETTY_FUNCTION__ );
-    }
-    g_free (query);
-    LOG_WARNING(MSGID_NOTIFICATIONMGR, 0, "[%s:%d]", __FUNCTION__, __LINE__);
-
-    return true;
+    std::string payload = findPayload(std::move(query), limit, page);
 
+    LOG_WARNING(MSGID_NOTIFICATIONMGR, 0, "[%s:%d] query = %s", __FUNCTION__, __LINE__, payload.c_str());
+    return startQuery(lshandle, message, std::move(request), payload, History::cbDb8getRemoteNotiResponse);
 }
 
 
@@ -276,7 +377,6 @@ bool History::deleteNotiMessage(pbnjson::JValue notificationPayload)
 
 bool History::deleteNotiMessageFromDb(LSHandle* lsHandle, pbnjson::JValue notificationPayload, const std::string& id, const std::string& idName, const std::string& propertyName, const std::string& propertyNameInArray)
 {
-	LSErrorSafe lserror;
 	bool returnValue = true;
 
     std::string errText;
@@ -302,16 +402,9 @@ bool History::deleteNotiMessageFromDb(LSHandle* lsHandle, pbnjson::JValue notifi
             std::string notiId = removeNotiIdObj[index].asString();
             LOG_DEBUG("remove notiId Payload = %s", notiId.c_str());
 
-            gchar* query = g_strdup_printf ("{\"query\":{\"from\":\"com.webos.notificationhistory:1\",\"where\":[{\"prop\":\"%s\",\"op\":\"=\",\"val\":\"%s\"}]},\"purge\":true}", propertyNameInArray.c_str(), notiId.c_str());
-
-            LOG_WARNING(MSGID_NOTIFICATIONMGR, 0, "[%s:%d] query = %s", __FUNCTION__, __LINE__, query);
-            if (LSCallOneReply(NotificationService::instance()->getHandle(),"palm://com.palm.db/del",
-                            query,
-                            History::cbDb8Response,NULL,NULL, &lserror) == false) {
-                returnValue = false;
-                LOG_WARNING(MSGID_DEL_MSG_FAIL, 0, "Delete Message from History table call failed in %s", __PRETTY_FUNCTION__ );
-            }
-            g_free (query);
+            pbnjson::JValue query = pbnjson::JObject{{"from", DB8_KIND},
+                                           {"where", pbnjson::JArray{{{"prop", propertyNameInArray}, {"op", "="}, {"val", notiId}}}}};
+            applyDel(std::move(query));
             LOG_WARNING(MSGID_NOTIFICATIONMGR, 0, "[%s:%d]", __FUNCTION__, __LINE__);
         }
     }
@@ -326,16 +419,9 @@ bool History::deleteNotiMessageFromDb(LSHandle* lsHandle, pbnjson::JValue notifi
         else
         {
             LOG_DEBUG("remove notification = %s", removeNotiByName.c_str());
-            gchar* query = g_strdup_printf ("{\"query\":{\"from\":\"com.webos.notificationhistory:1\",\"where\":[{\"prop\":\"%s\",\"op\":\"=\",\"val\":\"%s\"}]},\"purge\":true}", propertyName.c_str(),removeNotiByName.c_str());
-
-            LOG_WARNING(MSGID_NOTIFICATIONMGR, 0, "[%s:%d] query = %s", __FUNCTION__, __LINE__, query);
-            if (LSCallOneReply(lsHandle,"palm://com.palm.db/del",
-                            query,
-                            History::cbDb8Response,NULL,NULL, &lserror) == false) {
-            	returnValue = false;
-                LOG_WARNING(MSGID_DEL_MSG_FAIL, 0, "Delete Message from History table call failed in %s", __PRETTY_FUNCTION__ );
-            }
-            g_free (query);
+            pbnjson::JValue query = pbnjson::JObject{{"from", DB8_KIND},
+                                           {"where", pbnjson::JArray{{{"prop", propertyName}, {"op", "="}, {"val", removeNotiByName}}}}};
+            applyDel(std::move(query));
             LOG_WARNING(MSGID_NOTIFICATIONMGR, 0, "[%s:%d]", __FUNCTION__, __LINE__);
         }
     }
@@ -451,8 +537,7 @@ bool History::cbDb8getNotiResponse(LSHandle* lshandle, LSMessage *message, void
     pbnjson::JValue resultArray;
     pbnjson::JValue notiInfoArray = pbnjson::Array();
 
-    History* object = (History*)user_data;
-    LSMessage* getNotiReplyMsg = object->getReplyMsg();
+    QueryContext* context = static_cast<QueryContext*>(user_data);
 
     JUtil::Error error;
 
@@ -573,6 +658,10 @@ Done:
     json.put("returnValue", success);
     json.put("notiInfo", notiInfoArray);
     json.put("count", resultArray.arraySize());
+    if(success && request.hasKey("next"))
+    {
+        json.put("next", request["next"]);
+    }
 
     if(!success)
     {
@@ -582,13 +671,7 @@ Done:
     std::string result = JUtil::jsonToString(std::move(json));
     LOG_DEBUG("==== cbDb8getNotiResponse Payload ==== %s", result.c_str());
 
-    if(!LSMessageReply( lshandle, getNotiReplyMsg, result.c_str(), &lserror))
-    {
-        return false;
-    }
-
-    LSMessageUnref(getNotiReplyMsg);
-    return true;
+    return History::instance()->finishQuery(lshandle, context, result);
 }
 
 bool History::cbDb8getToastResponse(LSHandle* lshandle, LSMessage *message, void *user_data)
@@ -598,17 +681,14 @@ bool History::cbDb8getToastResponse(LSHandle* lshandle, LSMessage *message, void
 
     pbnjson::JValue request;
     pbnjson::JValue resultArray;
-    pbnjson::JValue toastInfoArray = pbnjson::Array();
 
-    History* object = (History*)user_data;
-    LSMessage* getToastReplyMsg = object->getReplyMsg();
+    QueryContext* context = static_cast<QueryContext*>(user_data);
 
     JUtil::Error error;
 
     bool success = false;
 
     request = JUtil::parse(LSMessageGetPayload(message), "", &error);
-    std::string testJson = JUtil::jsonToString(request);
 
     if(request.isNull())
     {
@@ -626,104 +706,73 @@ bool History::cbDb8getToastResponse(LSHandle* lshandle, LSMessage *message, void
 
     resultArray = request["results"];
 
-    if(resultArray.isArray())
+    if(resultArray.isArray() && resultArray.arraySize() == 0)
     {
-        if(resultArray.arraySize() == 0)
-        {
-            LOG_DEBUG("DB result is 0 %s", __PRETTY_FUNCTION__);
-        }
-
-        for(ssize_t index = 0; index < resultArray.arraySize() ; ++index) {
-            pbnjson::JValue toastInfoObj = pbnjson::Object();
-            if(!resultArray[index]["sourceId"].isNull())
-            {
-                toastInfoObj.put("sourceId", resultArray[index]["sourceId"]);
-            }
-            if(!resultArray[index]["toastId"].isNull())
-            {
-                toastInfoObj.put("toastId", resultArray[index]["notiId"]);
-            }
-			else
-            {
-                std::string sourceId = resultArray[index]["sourceId"].asString();
-                std::string timestamp = resultArray[index]["timestamp"].asString();
-                toastInfoObj.put("toastId", (sourceId + "-" + timestamp));
-            }
-            if(!resultArray[index]["timestamp"].isNull())
-            {
-                toastInfoObj.put("timestamp", resultArray[index]["timestamp"]);
-            }
-            if(!resultArray[index]["iconUrl"].isNull())
-            {
-                toastInfoObj.put("iconUrl", resultArray[index]["iconUrl"]);
-            }
-            if(!resultArray[index]["iconPath"].isNull())
-            {
-                toastInfoObj.put("iconPath", resultArray[index]["iconPath"]);
-            }
-            if(!resultArray[index]["title"].isNull())
-            {
-                toastInfoObj.put("title", resultArray[index]["title"]);
-            }
-            if(!resultArray[index]["message"].isNull())
-            {
-                toastInfoObj.put("message", resultArray[index]["message"]);
-            }
-            if(!resultArray[index]["isSysReq"].isNull())
-            {
-                toastInfoObj.put("isSysReq", resultArray[index]["isSysReq"]);
-            }
-            if(!resultArray[index]["displayId"].isNull())
-            {
-                toastInfoObj.put("displayId", resultArray[index]["displayId"]);
-            }
-            if(!resultArray[index]["user"].isNull())
-            {
-                toastInfoObj.put("user", resultArray[index]["user"]);
-            }
-            if(!resultArray[index]["schedule"].isNull())
-            {
-                toastInfoObj.put("schedule", resultArray[index]["schedule"]);
-            }
-            if(!resultArray[index]["type"].isNull())
-            {
-                toastInfoObj.put("type", resultArray[index]["type"]);
-            }
-            if(!resultArray[index]["action"].isNull())
-            {
-                toastInfoObj.put("action", resultArray[index]["action"]);
-            }
-            if(!resultArray[index]["readStatus"].isNull())
-            {
-                toastInfoObj.put("readStatus", resultArray[index]["readStatus"]);
-            }
-            toastInfoArray.put(index, toastInfoObj);
-        }
+        LOG_DEBUG("DB result is 0 %s", __PRETTY_FUNCTION__);
     }
 
     success = true;
 
 Done:
-    pbnjson::JValue json = pbnjson::Object();
-    json.put("returnValue", success);
-    json.put("toastInfo", toastInfoArray);
-    // json.put("count", resultArray.arraySize());
+    static JsonWriter writer(4096);
+    writer.clear();
+
+    writer.beginObject().member("returnValue", success);
+    writer.key("toastInfo").beginArray();
+    if(success && resultArray.isArray())
+    {
+        for(ssize_t index = 0; index < resultArray.arraySize() ; ++index) {
+            writeToastInfo(writer, resultArray[index]);
+        }
+    }
+    writer.endArray();
+    if(success && request.hasKey("next"))
+    {
+        writer.key("next").value(request["next"]);
+    }
 
     if(!success)
     {
-        json.put("errorText", errText);
+        writer.member("errorText", errText);
     }
+    writer.endObject();
 
-    std::string result = JUtil::jsonToString( std::move(json));
-    LOG_DEBUG("==== cbDb8getToastResponse Payload ==== %s", result.c_str());
+    LOG_DEBUG("==== cbDb8getToastResponse Payload ==== %s", writer.c_str());
 
-    if(!LSMessageReply( lshandle, getToastReplyMsg, result.c_str(), &lserror))
+    return History::instance()->finishQuery(lshandle, context, writer.str());
+}
+
+void History::writeToastInfo(JsonWriter& writer, const pbnjson::JValue& row)
+{
+    // Copied as they are, in this order, when present
+    static const char* const keys[] = {
+        "timestamp", "iconUrl", "iconPath", "title", "message", "isSysReq",
+        "displayId", "user", "schedule", "type", "action", "readStatus"
+    };
+
+    writer.beginObject();
+    if(!row["sourceId"].isNull())
     {
-        return false;
+        writer.key("sourceId").value(row["sourceId"]);
+    }
+    if(!row["toastId"].isNull())
+    {
+        writer.key("toastId").value(row["notiId"]);
+    }
+    else
+    {
+        writer.member("toastId", row["sourceId"].asString() + "-" + row["timestamp"].asString());
     }
 
-    LSMessageUnref(getToastReplyMsg);
-    return true;
+    for (const char* key : keys)
+    {
+        pbnjson::JValue value = row[key];
+        if(!value.isNull())
+        {
+            writer.key(key).value(value);
+        }
+    }
+    writer.endObject();
 }
 
 bool History::cbDb8getRemoteNotiResponse(LSHandle* lshandle, LSMessage *message, void *user_data)
@@ -735,8 +784,7 @@ bool History::cbDb8getRemoteNotiResponse(LSHandle* lshandle, LSMessage *message,
     pbnjson::JValue resultArray;
     pbnjson::JValue remoteNotiInfoArray = pbnjson::Array();
 
-    History* object = (History*)user_data;
-    LSMessage* getNotiReplyMsg = object->getReplyMsg();
+    QueryContext* context = static_cast<QueryContext*>(user_data);
 
     JUtil::Error error;
 
@@ -890,6 +938,10 @@ Done:
     json.put("returnValue", success);
     json.put("notiInfo", remoteNotiInfoArray);
     json.put("count", resultArray.arraySize());
+    if(success && request.hasKey("next"))
+    {
+        json.put("next", request["next"]);
+    }
 
     if(!success)
     {
@@ -899,86 +951,142 @@ Done:
     std::string result = JUtil::jsonToString(std::move(json));
     LOG_DEBUG("==== cbDb8getRemoteNotiResponse Payload ==== %s", result.c_str());
 
-    if(!LSMessageReply( lshandle, getNotiReplyMsg, result.c_str(), &lserror))
+    return History::instance()->finishQuery(lshandle, context, result);
+}
+
+bool History::startQuery(LSHandle* lshandle, LSMessage *message, pbnjson::JValue params,
+                         const std::string& payload, LSFilterFunc callback)
+{
+    LSErrorSafe lserror;
+
+    QueryContext* context;
+    if (m_queryPool.empty())
+    {
+        context = new QueryContext();
+    }
+    else
     {
+        context = m_queryPool.back();
+        m_queryPool.pop_back();
+    }
+
+    LSMessageRef(message);
+    context->reply = message;
+    context->params = std::move(params);
+    context->deadline = g_get_monotonic_time() + HISTORY_QUERY_TIMEOUT_MS * 1000;
+    context->token = LSMESSAGE_TOKEN_INVALID;
+
+    if (LSCallOneReply(lshandle, "palm://com.palm.db/find", payload.c_str(),
+                       callback, context, &context->token, &lserror) == false)
+    {
+        LOG_WARNING(MSGID_SAVE_MSG_FAIL, 0, "Select Message to History table call failed in %s", __PRETTY_FUNCTION__ );
+        releaseQuery(context);
         return false;
     }
 
-    LSMessageUnref(getNotiReplyMsg);
+    m_queries.insert(context);
+    if (!m_queryTimer)
+        m_queryTimer = g_timeout_add(HISTORY_QUERY_SWEEP_MS, History::cbQueryTimeout, this);
+
     return true;
 }
 
-LSMessage* History::getReplyMsg()
+bool History::finishQuery(LSHandle* lshandle, QueryContext* context, const std::string& reply)
+{
+    LSErrorSafe lserror;
+    bool replied = LSMessageReply(lshandle, context->reply, reply.c_str(), &lserror);
+    if (!replied)
+    {
+        LOG_WARNING(MSGID_FAILED_TO_RESPOND, 0, "Failed to reply history query in %s", __PRETTY_FUNCTION__ );
+    }
+
+    m_queries.erase(context);
+    releaseQuery(context);
+    return replied;
+}
+
+void History::releaseQuery(QueryContext* context)
 {
-    return replyMsg;
+    LSMessageUnref(context->reply);
+    context->reply = NULL;
+    context->params = pbnjson::JValue();
+
+    if (m_queryPool.size() < HISTORY_QUERY_POOL_SIZE)
+        m_queryPool.push_back(context);
+    else
+        delete context;
 }
 
-bool History::purgeAllData()
+gboolean History::cbQueryTimeout(gpointer data)
 {
-    LSErrorSafe lserror;
+    History* history = static_cast<History*>(data);
+    gint64 now = g_get_monotonic_time();
 
-    std::stringstream ss;
-    std::string purgePeriod = "9999999999";
+    for (auto it = history->m_queries.begin(); it != history->m_queries.end(); )
+    {
+        QueryContext* context = *it;
+        if (context->deadline > now)
+        {
+            ++it;
+            continue;
+        }
 
-    gchar* query = g_strdup_printf ("{\"query\":{\"from\":\"com.webos.notificationhistory:1\",\"where\":[{\"prop\":\"isUnDeletable\",\"op\":\"=\",\"val\":false},{\"prop\":\"timestamp\",\"op\":\"<\",\"val\":\"%s\"}]},\"purge\":true}", purgePeriod.c_str());
+        LOG_WARNING(MSGID_DB8_CALL_FAILED, 0, "History query timed out: %s", JUtil::jsonToString(context->params).c_str());
 
-    if (LSCallOneReply(NotificationService::instance()->getHandle(),"palm://com.palm.db/del",
-                            query,
-                            History::cbDb8Response,NULL,NULL, &lserror) == false) {
-                LOG_WARNING(MSGID_PURGE_FAIL, 0,"PurgeAllData Db8 LS2 call failed in %s", __PRETTY_FUNCTION__ );
+        LSErrorSafe lserror;
+        LSCallCancel(NotificationService::instance()->getHandle(), context->token, &lserror);
+
+        std::string reply = JUtil::jsonToString(pbnjson::JObject{{"returnValue", false}, {"errorText", "Db8 query timed out"}});
+        if (!LSMessageReply(NotificationService::instance()->getHandle(), context->reply, reply.c_str(), &lserror))
+        {
+            LOG_WARNING(MSGID_FAILED_TO_RESPOND, 0, "Failed to reply history query in %s", __PRETTY_FUNCTION__ );
+        }
+
+        it = history->m_queries.erase(it);
+        history->releaseQuery(context);
     }
-    g_free (query);
 
-    return true;
+    if (!history->m_queries.empty())
+        return G_SOURCE_CONTINUE;
+
+    history->m_queryTimer = 0;
+    return G_SOURCE_REMOVE;
 }
 
-bool History::resetUserNotifications(int displayId)
+bool History::purgeAllData()
 {
-    LSErrorSafe lserror;
+    std::string purgePeriod = "9999999999";
 
-    pbnjson::JValue remove_query = pbnjson::Object();
-    pbnjson::JValue request;
+    pbnjson::JValue query = pbnjson::JObject{{"from", DB8_KIND},
+                                   {"where", pbnjson::JArray{{{"prop", "isUnDeletable"}, {"op", "="}, {"val", false}},
+                                                             {{"prop", "timestamp"}, {"op", "<"}, {"val", purgePeriod}}}}};
+    applyDel(std::move(query));
 
-    request = pbnjson::JObject{{"from", DB8_KIND},
-                               {"where", pbnjson::JArray{{{"prop", "displayId"}, {"op", "="}, {"val", displayId}}}}};
-    remove_query.put("query", request);
+    return true;
+}
 
-    if (LSCallOneReply(NotificationService::instance()->getHandle(),"palm://com.palm.db/del",
-                       JUtil::jsonToString( std::move(remove_query)).c_str(),
-                       History::cbDb8Response,NULL,NULL, &lserror) == false) {
-            LOG_WARNING(MSGID_PURGE_FAIL, 0,"PurgeAllData Db8 LS2 call failed in %s", __PRETTY_FUNCTION__ );
-    }
+bool History::resetUserNotifications(int displayId)
+{
+    pbnjson::JValue query = pbnjson::JObject{{"from", DB8_KIND},
+                                   {"where", pbnjson::JArray{{{"prop", "displayId"}, {"op", "="}, {"val", displayId}}}}};
+    applyDel(std::move(query));
 
     return true;
 }
 
 bool History::setReadStatus(std::string toastId, bool readStatus)
 {
-    LSErrorSafe lserror;
-    pbnjson::JValue request;
     pbnjson::JValue statusObj = pbnjson::Object();
-    pbnjson::JValue merge_query = pbnjson::Object();
 
-    int pos = toastId.find("-");
-    std::string timestamp = toastId.substr(pos + 1);
+    std::string timestamp = Utils::extractTimestampFromId(toastId);
 
     statusObj.put("readStatus", readStatus);
-    request = pbnjson::JObject{
-                {"from", DB8_KIND},
-                {"where", pbnjson::JArray{{{"prop", "timestamp"}, {"op", "="}, {"val", timestamp.c_str()}}}}};
-    merge_query.put("query", request);
-    merge_query.put("props", statusObj);
-
-    std::string msgPayload = pbnjson::JGenerator::serialize(merge_query, pbnjson::JSchemaFragment("{}"));
+    LOG_DEBUG("[setReadStatus] timestamp: %s, readStatus: %d", timestamp.c_str(), readStatus);
 
-    LOG_DEBUG("[setReadStatus] query: %s", msgPayload.c_str());
+    pbnjson::JValue query = pbnjson::JObject{{"from", DB8_KIND},
+                                             {"where", pbnjson::JArray{{{"prop", "timestamp"}, {"op", "="}, {"val", timestamp}}}}};
 
-    if (LSCallOneReply(NotificationService::instance()->getHandle(),"luna://com.webos.service.db/merge",
-                            msgPayload.c_str(),
-                            History::cbDb8Response,NULL,NULL, &lserror) == false) {
-                 LOG_WARNING(MSGID_SAVE_MSG_FAIL, 0, "Set Status to History table call failed in %s", __PRETTY_FUNCTION__ );
-                 return false;
-    }
+    applyMerge(std::move(query), std::move(statusObj));
     return true;
 }
 
@@ -993,37 +1101,123 @@ bool History::purgeExpireData()
         return false;
     }
 
-    std::string query =
-        std::string( R"({"query":{"from":"com.webos.notificationhistory:1","where":[)" ) +
-        std::string( R"({"prop":"schedule.expire","op":"<","val":)" ) +
-        Utils::toString(currTime) +
-        std::string( R"(}]},"purge":true})" );
+    if (!m_index.isReady())
+    {
+        // Expire times of rows not loaded yet are unknown, let db8 find them
+        pbnjson::JValue query = pbnjson::JObject{{"from", DB8_KIND},
+                                                 {"where", pbnjson::JArray{{{"prop", "schedule.expire"}, {"op", "<"}, {"val", static_cast<int64_t>(currTime)}}}}};
 
-    LOG_DEBUG("[purgeExpireData] query:%s", query.c_str());
+        LOG_DEBUG("[purgeExpireData] query:%s", JUtil::jsonToString(query).c_str());
 
-    LSErrorSafe lserror;
-    if (LSCallOneReply(NotificationService::instance()->getHandle(),"palm://com.palm.db/del",
-        query.c_str(),
-        History::cbDb8Response,NULL,NULL,&lserror) == false)
+        applyDel(std::move(query));
+        return true;
+    }
+
+    // Only the due rows, sent to db8 together as one batch
+    std::vector<std::string> timestamps = m_index.expired(currTime);
+    for (const std::string& timestamp : timestamps)
     {
-        LOG_WARNING(MSGID_EXPIRE_FAIL, 1,
-            PMLOGKS("REASON", lserror.message),
-            " ");
+        applyDel(pbnjson::JObject{{"from", DB8_KIND},
+                                  {"where", pbnjson::JArray{{{"prop", "timestamp"}, {"op", "="}, {"val", timestamp}}}}});
+    }
+
+    if (!timestamps.empty())
+    {
+        LOG_DEBUG("[purgeExpireData] %zu expired rows", timestamps.size());
+        m_journal.flush();
     }
 
+    scheduleExpiry();
     return true;
 }
 
+void History::onIndexReady()
+{
+    // The rows loaded may predate the lost writes, load them once more
+    if (m_reloadIndex)
+    {
+        m_reloadIndex = false;
+        m_journal.flush();
+        m_index.reload();
+        return;
+    }
+
+    scheduleExpiry();
+}
+
+void History::onJournalLost(size_t lost)
+{
+    LOG_WARNING(MSGID_SAVE_MSG_FAIL, 1,
+                PMLOGKFV("OPERATIONS", "%zu", lost),
+                "History lost writes, reloading its index");
+
+    // Everything still queued must reach db8 before it is read again
+    m_journal.flush();
+    if (!m_index.reload())
+        m_reloadIndex = true;
+}
+
+void History::scheduleExpiry()
+{
+    if (m_expireTimer)
+    {
+        g_source_remove(m_expireTimer);
+        m_expireTimer = 0;
+    }
+    m_expireAt = 0;
+
+    // Expire times are wall clock, meaningless until the time is synced
+    if (!m_expireData || !SystemTime::instance().isSynced() || !m_index.isReady())
+        return;
+
+    int64_t next = m_index.nextExpire();
+    if (next == 0 || next >= MAX_TIMESTAMP)
+        return;
+
+    time_t currTime = time(NULL);
+    if (currTime == -1)
+        return;
+
+    // A row expires once the time is past schedule.expire
+    int64_t wait = std::max<int64_t>(next + 1 - currTime, 0);
+    wait = std::min<int64_t>(wait, HISTORY_EXPIRE_MAX_WAIT_S);
+
+    m_expireAt = currTime + wait;
+    m_expireTimer = g_timeout_add_seconds(wait, History::cbExpireTimer, this);
+}
+
+void History::expiryAdded(int64_t expire)
+{
+    if (expire <= 0 || expire >= MAX_TIMESTAMP)
+        return;
+    if (!m_expireTimer || expire < m_expireAt)
+        scheduleExpiry();
+}
+
+gboolean History::cbExpireTimer(gpointer data)
+{
+    History* history = static_cast<History*>(data);
+    history->m_expireTimer = 0;
+    history->purgeExpireData();
+    return G_SOURCE_REMOVE;
+}
+
+void History::flush()
+{
+    m_journal.flush();
+}
+
 void History::onSystemTimeSync(bool sync)
 {
-    if (sync)
+    if (sync && !m_expireData)
     {
-        if (!m_expireData)
-        {
-            m_expireData = true;
-            purgeExpireData();
-        }
+        m_expireData = true;
+        purgeExpireData();
+        return;
     }
+
+    // The clock was set or lost its sync, the armed expiry is off
+    scheduleExpiry();
 }
 
 void History::onBoot(const std::string &boot)
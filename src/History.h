@@ -19,48 +19,114 @@
 
 #include <string>
 #include <stdlib.h>
+#include <set>
+#include <vector>
+#include <glib.h>
 #include <luna-service2/lunaservice.h>
 #include <pbnjson.hpp>
 #include <boost/signals2.hpp>
 
+#include "DbJournal.h"
+#include "ToastIndex.h"
+#include "ToastCounter.h"
+#include "JsonWriter.h"
+
 class History
 {
 public:
     History();
     ~History();
     static History* instance();
+    //! True once instance() has created the history
+    static bool hasInstance();
 
     static bool cbDb8Response(LSHandle* lshandle, LSMessage *message, void *user_data);
     static bool cbDb8getNotiResponse(LSHandle * lshandle,LSMessage * message,void * user_data);
     static bool cbDb8getRemoteNotiResponse(LSHandle * lshandle,LSMessage * message,void * user_data);
     static bool cbDb8getToastResponse(LSHandle* lshandle, LSMessage *message, void *user_data);
+    static void writeToastInfo(JsonWriter& writer, const pbnjson::JValue& row);
 
-    void saveMessage(pbnjson::JValue msg);
+    /*! Store msg. body may hold msg already serialized, it is then written
+     * to db8 as is instead of being generated again. A msg with a collapseKey
+     * replaces the stored toast of the same source and key, which is
+     * deleted and put again in the same journal batch.
+     */
+    void saveMessage(pbnjson::JValue msg, const std::string& body = std::string());
     void deleteMessage(const std::string &key, const std::string& value);
+    /*! Timestamp of the stored toast of sourceId with collapseKey, empty if
+     * there is none or the history is still being loaded.
+     */
+    std::string findCollapsed(const std::string& sourceId, const std::string& collapseKey) const;
     bool purgeAllData();
+    /*! Delete the toasts whose schedule.expire has passed. Once the index
+     * is loaded only the due rows are deleted, and a timer is armed for the
+     * next expiry so toasts leave the history as soon as they expire.
+     */
     bool purgeExpireData();
     bool setReadStatus(std::string toastId, bool readStatus);
     bool resetUserNotifications(int displayId);
 
-    bool selectMessage(LSHandle* lshandle, const std::string& id, LSMessage *message);
+    bool selectMessage(LSHandle* lshandle, const std::string& id, LSMessage *message, int limit = 0, const std::string& page = "");
     bool selectToastMessage(LSHandle* lshandle, const std::string& id, LSMessage *message);
-    bool selectRemoteMessage(LSHandle* lshandle, const std::string& id, LSMessage *message);
+    bool selectRemoteMessage(LSHandle* lshandle, const std::string& id, LSMessage *message, int limit = 0, const std::string& page = "");
     bool deleteNotiMessage(pbnjson::JValue notificationPayload);
     bool deleteRemoteNotiMessage(LSHandle* lsHandle, pbnjson::JValue notificationPayload);
-    LSMessage* getReplyMsg();
+
+    //! Write pending history changes to db8 immediately
+    void flush();
 
 protected:
     void onSystemTimeSync(bool sync);
     void onBoot(const std::string &boot);
 
 private:
-    LSMessage* replyMsg;
+    //! State of one db8 find until its reply is sent
+    struct QueryContext {
+        LSMessage* reply;
+        pbnjson::JValue params;
+        gint64 deadline;
+        LSMessageToken token;
+    };
+
+    bool startQuery(LSHandle* lshandle, LSMessage *message, pbnjson::JValue params,
+                    const std::string& payload, LSFilterFunc callback);
+    bool finishQuery(LSHandle* lshandle, QueryContext* context, const std::string& reply);
+    void releaseQuery(QueryContext* context);
+    static gboolean cbQueryTimeout(gpointer data);
+
+    //! Apply a del or merge to the index and queue it for db8
+    void applyDel(pbnjson::JValue query);
+    void applyMerge(pbnjson::JValue query, pbnjson::JValue props);
+
+    void onIndexReady();
+    //! db8 lost writes the index already has, load the index again
+    void onJournalLost(size_t lost);
+
+    //! Arm the expiry timer for the earliest expire time of the index
+    void scheduleExpiry();
+    //! A row expiring at expire was stored, arm the timer earlier if needed
+    void expiryAdded(int64_t expire);
+    static gboolean cbExpireTimer(gpointer data);
+
     bool m_expireData;
+    guint m_expireTimer;
+    int64_t m_expireAt;     // wall clock time the expiry timer fires
+    bool m_reloadIndex;     // writes were lost while the index was loading
+    DbJournal m_journal;
+    ToastIndex m_index;
+    ToastCounter m_counter;
+
+    std::set<QueryContext*> m_queries;
+    std::vector<QueryContext*> m_queryPool;
+    guint m_queryTimer;
+
     bool selectNotiMessageFromDb(LSHandle* lshandle, const std::string& id, LSMessage *message, const std::string& property, const std::string& isRemote);
     bool deleteNotiMessageFromDb(LSHandle* lsHandle, pbnjson::JValue notificationPayload, const std::string& id, const std::string& idName, const std::string& propertyName, const std::string& propertyNameInArray);
 
     boost::signals2::scoped_connection m_connSystemTimeSync;
     boost::signals2::scoped_connection m_connBootStatus;
+    boost::signals2::scoped_connection m_connIndexReady;
+    boost::signals2::scoped_connection m_connJournalLost;
 };
 
 #endif
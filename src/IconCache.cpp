@@ -0,0 +1,173 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "IconCache.h"
+#include "FileWatcher.h"
+#include "Settings.h"
+#include "Utils.h"
+#include "Logging.h"
+
+#define ICON_CACHE_MAX_ENTRIES 4096
+#define ICON_CACHE_MAX_WATCHES 512
+#define ICON_CACHE_PREWARM_BATCH 16
+
+using namespace std::placeholders;
+
+static std::string dirName(const std::string& path)
+{
+    size_t pos = path.rfind('/');
+    if (pos == std::string::npos)
+        return ".";
+    if (pos == 0)
+        return "/";
+    return path.substr(0, pos);
+}
+
+IconCache::IconCache()
+    : m_prewarmSource(0)
+    , m_hits(0)
+    , m_misses(0)
+    , m_invalidations(0)
+{
+    m_connChanged = FileWatcher::instance().sigChanged.connect(
+        std::bind(&IconCache::onChanged, this, _1, _2)
+    );
+
+    FileWatcher::instance().watch(dirName(s_defaultToastIcon));
+    FileWatcher::instance().watch(dirName(s_defaultAlertIcon));
+}
+
+IconCache::~IconCache()
+{
+    if (m_prewarmSource)
+        g_source_remove(m_prewarmSource);
+}
+
+bool IconCache::resolve(const std::string& path, std::string* url)
+{
+    if (path.empty())
+        return false;
+
+    auto it = m_entries.find(path);
+    if (it != m_entries.end())
+    {
+        m_hits++;
+        if (url && it->second.exists)
+            *url = it->second.url;
+        return it->second.exists;
+    }
+
+    m_misses++;
+
+    Entry entry;
+    entry.exists = Utils::verifyFileExist(path.c_str());
+    if (entry.exists)
+        entry.url = "file://" + path;
+
+    if (url && entry.exists)
+        *url = entry.url;
+
+    // Without a watch nothing would tell us the entry went stale
+    std::string dir = dirName(path);
+    FileWatcher& watcher = FileWatcher::instance();
+    if (!watcher.isWatched(dir) && (watcher.count() >= ICON_CACHE_MAX_WATCHES || !watcher.watch(dir)))
+        return entry.exists;
+
+    if (m_entries.size() >= ICON_CACHE_MAX_ENTRIES)
+        m_entries.clear();
+
+    bool exists = entry.exists;
+    m_entries.emplace(path, std::move(entry));
+    return exists;
+}
+
+void IconCache::prewarm(const std::string& path)
+{
+    if (path.empty() || m_entries.count(path))
+        return;
+
+    m_prewarm.push_back(path);
+    if (!m_prewarmSource)
+        m_prewarmSource = g_idle_add_full(G_PRIORITY_LOW, IconCache::cbPrewarm, this, NULL);
+}
+
+gboolean IconCache::cbPrewarm(gpointer data)
+{
+    IconCache* cache = static_cast<IconCache*>(data);
+
+    // A few at a time so a full listApps reply doesn't stall the loop
+    for (int i = 0; i < ICON_CACHE_PREWARM_BATCH && !cache->m_prewarm.empty(); ++i)
+    {
+        std::string path = std::move(cache->m_prewarm.front());
+        cache->m_prewarm.pop_front();
+
+        if (cache->m_entries.count(path))
+            continue;
+
+        // Not a request, keep it out of the hit/miss counters
+        unsigned long misses = cache->m_misses;
+        cache->resolve(path);
+        cache->m_misses = misses;
+    }
+
+    if (!cache->m_prewarm.empty())
+        return G_SOURCE_CONTINUE;
+
+    cache->m_prewarmSource = 0;
+    return G_SOURCE_REMOVE;
+}
+
+void IconCache::onChanged(const std::string& dir, const std::string& name)
+{
+    if (dir.empty())
+    {
+        m_invalidations += m_entries.size();
+        m_entries.clear();
+        return;
+    }
+
+    if (!name.empty())
+    {
+        m_invalidations += m_entries.erase(dir + "/" + name);
+        return;
+    }
+
+    // The directory itself is gone
+    std::string prefix = dir + "/";
+    for (auto it = m_entries.begin(); it != m_entries.end(); )
+    {
+        if (it->first.compare(0, prefix.size(), prefix) == 0 && it->first.find('/', prefix.size()) == std::string::npos)
+        {
+            it = m_entries.erase(it);
+            m_invalidations++;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+pbnjson::JValue IconCache::stats() const
+{
+    pbnjson::JValue json = pbnjson::Object();
+    json.put("hits", static_cast<int64_t>(m_hits));
+    json.put("misses", static_cast<int64_t>(m_misses));
+    json.put("invalidations", static_cast<int64_t>(m_invalidations));
+    json.put("entries", static_cast<int64_t>(m_entries.size()));
+    json.put("watches", static_cast<int64_t>(FileWatcher::instance().count()));
+    return json;
+}
@@ -0,0 +1,68 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __ICONCACHE_H__
+#define __ICONCACHE_H__
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <glib.h>
+#include <pbnjson.hpp>
+#include <boost/signals2.hpp>
+
+#include "Singleton.hpp"
+
+/*! Remembers whether icon files exist so requests don't stat() them each time.
+ * Missing files are cached as well. Entries are dropped when FileWatcher
+ * reports a change in their directory, so only paths in directories that
+ * can be watched are cached.
+ */
+class IconCache : public Singleton<IconCache>
+{
+public:
+    IconCache();
+    ~IconCache();
+
+    //! True if path exists, url receives its file:// form
+    bool resolve(const std::string& path, std::string* url = NULL);
+
+    //! Resolve path later from an idle callback
+    void prewarm(const std::string& path);
+
+    pbnjson::JValue stats() const;
+
+private:
+    struct Entry {
+        bool exists;
+        std::string url;
+    };
+
+    void onChanged(const std::string& dir, const std::string& name);
+    static gboolean cbPrewarm(gpointer data);
+
+    std::unordered_map<std::string, Entry> m_entries;
+    std::deque<std::string> m_prewarm;
+    guint m_prewarmSource;
+
+    unsigned long m_hits;
+    unsigned long m_misses;
+    unsigned long m_invalidations;
+
+    boost::signals2::scoped_connection m_connChanged;
+};
+
+#endif
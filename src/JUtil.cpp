@@ -16,6 +16,47 @@
 
 #include "JUtil.h"
 #include "Utils.h"
+#include "Logging.h"
+#include "FileWatcher.h"
+
+#include <string.h>
+
+using namespace std::placeholders;
+
+#define SCHEMA_SUFFIX ".schema"
+
+static bool isSchemaFile(const std::string &name)
+{
+    static const size_t suffixLen = strlen(SCHEMA_SUFFIX);
+    return name.size() > suffixLen && name.compare(name.size() - suffixLen, suffixLen, SCHEMA_SUFFIX) == 0;
+}
+
+// Requests of these methods are validated by the parsers generated from
+// their schemas at build time (tools/gen_request_parsers.py). Their JSchema
+// is never used, so they aren't precompiled, and editing the files on the
+// device has no effect until the service is rebuilt.
+static const char* const s_generatedSchemas[] = {
+    "createToast", "createToasts", "createAlert", "closeToast", "setToastStatus"
+};
+
+static bool isGeneratedSchema(const std::string &name)
+{
+    for (const char* generated : s_generatedSchemas)
+    {
+        if (name == generated)
+            return true;
+    }
+    return false;
+}
+
+//! kSchemaPath without the trailing '/', as FileWatcher reports it
+static std::string schemaDir()
+{
+    std::string dir(kSchemaPath);
+    if (dir.size() > 1 && dir[dir.size() - 1] == '/')
+        dir.erase(dir.size() - 1);
+    return dir;
+}
 
 JUtil::Error::Error()
     : m_code(Error::None)
@@ -51,11 +92,15 @@ void JUtil::Error::set(ErrorCode code, const char *detail)
 }
 
 JUtil::JUtil()
+    : m_preloadThread(NULL)
+    , m_preloadElapsed(0)
+    , m_reloads(0)
 {
 }
 
 JUtil::~JUtil()
 {
+    waitForSchemas();
 }
 
 pbnjson::JValue JUtil::parse(const char *rawData, const std::string &schemaName, Error *error)
@@ -101,7 +146,7 @@ pbnjson::JSchema JUtil::loadSchema(const std::string& schemaName, bool cache)
 
     if (cache)
     {
-        std::map< std::string, pbnjson::JSchema >::iterator it = m_mapSchema.find(schemaName);
+        auto it = m_mapSchema.find(schemaName);
         if (it != m_mapSchema.end())
             return it->second;
     }
@@ -118,7 +163,168 @@ pbnjson::JSchema JUtil::loadSchema(const std::string& schemaName, bool cache)
     return schema;
 }
 
+void JUtil::preloadSchemas()
+{
+    if (m_preloadThread)
+        return;
+
+    m_preload = Preload();
+    m_preloadThread = g_thread_new("schema-preload", JUtil::compileSchemas, &m_preload);
+}
+
+gpointer JUtil::compileSchemas(gpointer data)
+{
+    // Runs on the worker, so it only touches the Preload it was given
+    Preload *preload = static_cast<Preload*>(data);
+    gint64 start = g_get_monotonic_time();
+
+    GDir *dir = g_dir_open(kSchemaPath, 0, NULL);
+    if (dir)
+    {
+        const gchar *entry;
+        while ((entry = g_dir_read_name(dir)) != NULL)
+        {
+            std::string file(entry);
+            if (!isSchemaFile(file))
+                continue;
+
+            std::string name = file.substr(0, file.size() - strlen(SCHEMA_SUFFIX));
+            if (isGeneratedSchema(name))
+                continue;
+
+            gint64 begin = g_get_monotonic_time();
+            pbnjson::JSchema schema = pbnjson::JSchemaFile(kSchemaPath + file);
+            if (!schema.isInitialized())
+                continue;
+
+            preload->loadTimes.push_back(std::make_pair(name, g_get_monotonic_time() - begin));
+            preload->schemas.push_back(std::make_pair(std::move(name), std::move(schema)));
+        }
+        g_dir_close(dir);
+    }
+
+    preload->elapsed = g_get_monotonic_time() - start;
+    return NULL;
+}
+
+void JUtil::waitForSchemas()
+{
+    if (!m_preloadThread)
+        return;
+
+    g_thread_join(m_preloadThread);
+    m_preloadThread = NULL;
+
+    for (auto &loaded : m_preload.schemas)
+    {
+        m_mapSchema.erase(loaded.first);
+        m_mapSchema.insert(std::move(loaded));
+    }
+
+    for (const auto &loadTime : m_preload.loadTimes)
+    {
+        LOG_INFO(MSGID_SCHEMA_LOADED, 2,
+            PMLOGKS("SCHEMA", loadTime.first.c_str()),
+            PMLOGKFV("USEC", "%lld", static_cast<long long>(loadTime.second)),
+            " ");
+    }
+
+    m_preloadElapsed = m_preload.elapsed;
+    LOG_INFO(MSGID_SCHEMA_LOADED, 2,
+        PMLOGKFV("COUNT", "%zu", m_preload.schemas.size()),
+        PMLOGKFV("USEC", "%lld", static_cast<long long>(m_preloadElapsed)),
+        "Schemas precompiled");
+
+    m_preload = Preload();
+}
+
+void JUtil::watchSchemas()
+{
+    if (m_connSchemaChanged.connected())
+        return;
+
+    m_connSchemaChanged = FileWatcher::instance().sigChanged.connect(
+        std::bind(&JUtil::onSchemaChanged, this, _1, _2)
+    );
+
+    if (!FileWatcher::instance().watch(schemaDir()))
+        LOG_WARNING(MSGID_SCHEMA_LOAD_FAIL, 1, PMLOGKS("PATH", kSchemaPath), "Schema directory can't be watched");
+}
+
+void JUtil::onSchemaChanged(const std::string &dir, const std::string &name)
+{
+    // Empty dir means events were dropped, anything may have changed
+    if (!dir.empty() && dir != schemaDir())
+        return;
+
+    std::vector<std::string> names;
+    if (!name.empty())
+    {
+        if (!isSchemaFile(name))
+            return;
+        names.push_back(name.substr(0, name.size() - strlen(SCHEMA_SUFFIX)));
+    }
+    else
+    {
+        for (const auto &cached : m_mapSchema)
+            names.push_back(cached.first);
+    }
+
+    for (const auto &schemaName : names)
+    {
+        if (isGeneratedSchema(schemaName))
+        {
+            LOG_WARNING(MSGID_SCHEMA_GENERATED, 1, PMLOGKS("SCHEMA", schemaName.c_str()),
+                        "Schema changed, but its requests are validated by the parser generated at build time");
+            continue;
+        }
+
+        // A removed or broken file drops the entry, the next lookup retries
+        m_mapSchema.erase(schemaName);
+        pbnjson::JSchema schema = loadSchema(schemaName, true);
+        m_reloads++;
+
+        if (!schema.isInitialized())
+            LOG_WARNING(MSGID_SCHEMA_LOAD_FAIL, 1, PMLOGKS("SCHEMA", schemaName.c_str()), "Schema reload failed");
+        else
+            LOG_DEBUG("Schema %s reloaded", schemaName.c_str());
+    }
+
+    // The directory was replaced, watch the new one
+    if (!dir.empty() && name.empty())
+        FileWatcher::instance().watch(dir);
+}
+
+pbnjson::JValue JUtil::schemaStats() const
+{
+    pbnjson::JValue json = pbnjson::Object();
+    json.put("schemas", static_cast<int64_t>(m_mapSchema.size()));
+    json.put("preloadMs", static_cast<double>(m_preloadElapsed) / 1000.0);
+    json.put("reloads", static_cast<int64_t>(m_reloads));
+    return json;
+}
+
 std::string JUtil::jsonToString(pbnjson::JValue json)
 {
     return pbnjson::JGenerator::serialize(json, pbnjson::JSchemaFragment("{}"));
 }
+
+std::string JUtil::prependMembers(const std::string &json, const std::string &members)
+{
+    if (members.empty())
+        return json;
+    if (json.empty())
+        return "{" + members + "}";
+
+    std::string result;
+    result.reserve(json.size() + members.size() + 2);
+    result += '{';
+    result += members;
+
+    // json is "{}" or "{...}"
+    size_t body = json.find_first_not_of(" \t\r\n", 1);
+    if (body != std::string::npos && json[body] != '}')
+        result += ',';
+    result.append(json, 1, std::string::npos);
+    return result;
+}
@@ -15,6 +15,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "JsonParser.h"
+#include "IconCache.h"
 #include "Utils.h"
 #include "Logging.h"
 
@@ -53,9 +54,10 @@ pbnjson::JValue JsonParser::createInputAlertInfo(pbnjson::JValue src, std::strin
     std::string portIcon = src["portIcon"].asString();
     if (portIcon.length() != 0)
     {
-        if (Utils::verifyFileExist(portIcon.c_str()))
+        std::string portIconUrl;
+        if (IconCache::instance().resolve(portIcon, &portIconUrl))
         {
-            alertInfo.put("portIcon", "file://"+portIcon);
+            alertInfo.put("portIcon", portIconUrl);
         }
         else
         {
@@ -81,9 +83,10 @@ pbnjson::JValue JsonParser::createInputAlertInfo(pbnjson::JValue src, std::strin
     std::string deviceIcon = src["deviceIcon"].asString();
     if (deviceIcon.length() != 0)
     {
-        if (Utils::verifyFileExist(deviceIcon.c_str()))
+        std::string deviceIconUrl;
+        if (IconCache::instance().resolve(deviceIcon, &deviceIconUrl))
         {
-            alertInfo.put("deviceIcon", "file://"+deviceIcon);
+            alertInfo.put("deviceIcon", deviceIconUrl);
         }
         else
         {
@@ -104,19 +107,23 @@ pbnjson::JValue JsonParser::createInputAlertInfo(pbnjson::JValue src, std::strin
 
 pbnjson::JValue JsonParser::createActionInfo(pbnjson::JValue src)
 {
-    pbnjson::JValue action = pbnjson::Object();
-
     if (src.isNull())
-        return action;
+        return pbnjson::Object();
+
+    return createActionInfo(src["uri"].asString(), src["params"]);
+}
+
+pbnjson::JValue JsonParser::createActionInfo(const std::string& uri, const pbnjson::JValue& params)
+{
+    pbnjson::JValue action = pbnjson::Object();
 
-    std::string uri = src["uri"].asString();
     if (Utils::isValidURI(uri))
     {
         unsigned found = uri.find_last_of("/");
         action.put("serviceURI", uri.substr(0, found + 1));
         action.put("serviceMethod", uri.substr(found + 1));
-        if (!src["params"].isNull())
-            action.put("launchParams", src["params"]);
+        if (!params.isNull())
+            action.put("launchParams", params);
         else
             action.put("launchParams", {});
     }
@@ -21,4 +21,5 @@ class JsonParser
 public:
     static pbnjson::JValue createInputAlertInfo(pbnjson::JValue src, std::string &errText);
     static pbnjson::JValue createActionInfo(pbnjson::JValue src);
+    static pbnjson::JValue createActionInfo(const std::string& uri, const pbnjson::JValue& params);
 };
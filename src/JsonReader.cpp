@@ -0,0 +1,404 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "JsonReader.h"
+#include "JUtil.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Deeper documents are rejected rather than risking the stack in skipValue()
+#define JSON_READER_MAX_DEPTH 64
+
+static int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+static void appendUtf8(std::string& out, uint32_t cp)
+{
+    if (cp < 0x80)
+    {
+        out += static_cast<char>(cp);
+    }
+    else if (cp < 0x800)
+    {
+        out += static_cast<char>(0xc0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3f));
+    }
+    else if (cp < 0x10000)
+    {
+        out += static_cast<char>(0xe0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (cp & 0x3f));
+    }
+    else
+    {
+        out += static_cast<char>(0xf0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (cp & 0x3f));
+    }
+}
+
+JsonReader::JsonReader(const char* json)
+    : m_pos(json ? json : "")
+    , m_failed(false)
+{
+}
+
+void JsonReader::skipSpace()
+{
+    while (*m_pos == ' ' || *m_pos == '\t' || *m_pos == '\n' || *m_pos == '\r')
+        ++m_pos;
+}
+
+bool JsonReader::fail()
+{
+    m_failed = true;
+    return false;
+}
+
+bool JsonReader::expect(char c)
+{
+    skipSpace();
+    if (*m_pos != c)
+        return fail();
+    ++m_pos;
+    return true;
+}
+
+JsonReader::Token JsonReader::peek()
+{
+    if (m_failed)
+        return INVALID;
+
+    skipSpace();
+    switch (*m_pos)
+    {
+    case '\0': return END;
+    case '{': return BEGIN_OBJECT;
+    case '}': return END_OBJECT;
+    case '[': return BEGIN_ARRAY;
+    case ']': return END_ARRAY;
+    case '"': return STRING;
+    case 't':
+    case 'f': return BOOLEAN;
+    case 'n': return NUL;
+    default:
+        if (*m_pos == '-' || (*m_pos >= '0' && *m_pos <= '9'))
+            return NUMBER;
+        return INVALID;
+    }
+}
+
+bool JsonReader::beginObject()
+{
+    return expect('{');
+}
+
+bool JsonReader::nextMember(std::string& key, bool& first)
+{
+    skipSpace();
+    if (*m_pos == '}')
+    {
+        ++m_pos;
+        return false;
+    }
+
+    if (!first && !expect(','))
+        return false;
+    first = false;
+
+    skipSpace();
+    if (*m_pos != '"')
+        return fail();
+    if (!readString(key))
+        return false;
+    return expect(':');
+}
+
+bool JsonReader::beginArray()
+{
+    return expect('[');
+}
+
+bool JsonReader::nextElement(bool& first)
+{
+    skipSpace();
+    if (*m_pos == ']')
+    {
+        ++m_pos;
+        return false;
+    }
+
+    if (!first && !expect(','))
+        return false;
+    first = false;
+
+    // A trailing comma is not an element
+    skipSpace();
+    if (*m_pos == ']')
+        return fail();
+    return true;
+}
+
+bool JsonReader::readString(std::string& value)
+{
+    if (peek() != STRING)
+        return false;
+
+    value.clear();
+    ++m_pos;
+
+    const char* run = m_pos;
+    while (*m_pos != '"')
+    {
+        unsigned char c = static_cast<unsigned char>(*m_pos);
+        if (c < 0x20)
+            return fail();
+
+        if (c != '\\')
+        {
+            ++m_pos;
+            continue;
+        }
+
+        value.append(run, m_pos - run);
+        ++m_pos;
+
+        switch (*m_pos++)
+        {
+        case '"':  value += '"'; break;
+        case '\\': value += '\\'; break;
+        case '/':  value += '/'; break;
+        case 'b':  value += '\b'; break;
+        case 'f':  value += '\f'; break;
+        case 'n':  value += '\n'; break;
+        case 'r':  value += '\r'; break;
+        case 't':  value += '\t'; break;
+        case 'u':
+        {
+            uint32_t cp = 0;
+            for (int i = 0; i < 4; ++i)
+            {
+                int digit = hexValue(*m_pos++);
+                if (digit < 0)
+                    return fail();
+                cp = (cp << 4) | digit;
+            }
+
+            // Combine a surrogate pair, a lone surrogate becomes U+FFFD
+            if (cp >= 0xd800 && cp <= 0xdbff && m_pos[0] == '\\' && m_pos[1] == 'u')
+            {
+                // Stop at the first non hex byte, the payload may end right here
+                uint32_t low = 0;
+                int i = 2;
+                for (; i < 6; ++i)
+                {
+                    int digit = hexValue(m_pos[i]);
+                    if (digit < 0)
+                        break;
+                    low = (low << 4) | digit;
+                }
+                if (i == 6 && low >= 0xdc00 && low <= 0xdfff)
+                {
+                    cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+                    m_pos += 6;
+                }
+            }
+            if (cp >= 0xd800 && cp <= 0xdfff)
+                cp = 0xfffd;
+
+            appendUtf8(value, cp);
+            break;
+        }
+        default:
+            return fail();
+        }
+        run = m_pos;
+    }
+
+    value.append(run, m_pos - run);
+    ++m_pos;
+    return true;
+}
+
+bool JsonReader::scanNumber(const char*& end)
+{
+    const char* p = m_pos;
+
+    if (*p == '-')
+        ++p;
+    if (*p == '0')
+        ++p;
+    else if (*p >= '1' && *p <= '9')
+        while (*p >= '0' && *p <= '9')
+            ++p;
+    else
+        return fail();
+
+    if (*p == '.')
+    {
+        ++p;
+        if (!(*p >= '0' && *p <= '9'))
+            return fail();
+        while (*p >= '0' && *p <= '9')
+            ++p;
+    }
+
+    if (*p == 'e' || *p == 'E')
+    {
+        ++p;
+        if (*p == '+' || *p == '-')
+            ++p;
+        if (!(*p >= '0' && *p <= '9'))
+            return fail();
+        while (*p >= '0' && *p <= '9')
+            ++p;
+    }
+
+    end = p;
+    return true;
+}
+
+bool JsonReader::readNumber(double& value)
+{
+    if (peek() != NUMBER)
+        return false;
+
+    const char* end;
+    if (!scanNumber(end))
+        return false;
+
+    value = strtod(m_pos, NULL);
+    m_pos = end;
+    return true;
+}
+
+bool JsonReader::readInteger(int64_t& value)
+{
+    if (peek() != NUMBER)
+        return false;
+
+    const char* end;
+    if (!scanNumber(end))
+        return false;
+
+    double number = strtod(m_pos, NULL);
+    if (number != floor(number) || fabs(number) > 9007199254740992.0)
+        return false;
+
+    value = static_cast<int64_t>(number);
+    m_pos = end;
+    return true;
+}
+
+bool JsonReader::readBoolean(bool& value)
+{
+    if (peek() != BOOLEAN)
+        return false;
+
+    if (strncmp(m_pos, "true", 4) == 0)
+    {
+        value = true;
+        m_pos += 4;
+        return true;
+    }
+    if (strncmp(m_pos, "false", 5) == 0)
+    {
+        value = false;
+        m_pos += 5;
+        return true;
+    }
+    return fail();
+}
+
+bool JsonReader::skip()
+{
+    return skipValue(0);
+}
+
+bool JsonReader::skipValue(int depth)
+{
+    if (depth > JSON_READER_MAX_DEPTH)
+        return fail();
+
+    std::string ignored;
+    bool first = true;
+
+    switch (peek())
+    {
+    case BEGIN_OBJECT:
+        beginObject();
+        while (nextMember(ignored, first))
+            if (!skipValue(depth + 1))
+                return false;
+        return !m_failed;
+    case BEGIN_ARRAY:
+        beginArray();
+        while (nextElement(first))
+            if (!skipValue(depth + 1))
+                return false;
+        return !m_failed;
+    case STRING:
+        return readString(ignored);
+    case NUMBER:
+    {
+        const char* end;
+        if (!scanNumber(end))
+            return false;
+        m_pos = end;
+        return true;
+    }
+    case BOOLEAN:
+    {
+        bool b;
+        return readBoolean(b);
+    }
+    case NUL:
+        if (strncmp(m_pos, "null", 4) != 0)
+            return fail();
+        m_pos += 4;
+        return true;
+    default:
+        return fail();
+    }
+}
+
+bool JsonReader::readValue(pbnjson::JValue& value)
+{
+    skipSpace();
+    const char* start = m_pos;
+    if (!skip())
+        return false;
+
+    value = JUtil::parse(std::string(start, m_pos - start).c_str(), "");
+    return !value.isNull() || strncmp(start, "null", 4) == 0;
+}
+
+bool JsonReader::atEnd()
+{
+    skipSpace();
+    return *m_pos == '\0';
+}
@@ -0,0 +1,96 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __JSONREADER_H__
+#define __JSONREADER_H__
+
+#include <string>
+#include <stdint.h>
+#include <pbnjson.hpp>
+
+//! A request member and whether the request contained it
+template <typename T>
+struct JsonField
+{
+    T value;
+    bool set;
+
+    JsonField() : value(), set(false) {}
+};
+
+/*! Pull tokenizer over a JSON text, used by the generated request parsers
+ * (see tools/gen_request_parsers.py) to read a payload in one pass without
+ * building a DOM. Every read returns false on a syntax error or when the
+ * next value has another type; failed() tells the two apart.
+ *
+ *     bool first = true;
+ *     std::string key;
+ *     reader.beginObject();
+ *     while (reader.nextMember(key, first))
+ *         ...read or skip the value...
+ */
+class JsonReader
+{
+public:
+    enum Token {
+        INVALID,
+        END,
+        BEGIN_OBJECT,
+        END_OBJECT,
+        BEGIN_ARRAY,
+        END_ARRAY,
+        STRING,
+        NUMBER,
+        BOOLEAN,
+        NUL
+    };
+
+    explicit JsonReader(const char* json);
+
+    //! Type of the next value, nothing is consumed
+    Token peek();
+
+    bool beginObject();
+    //! Read the next member name, false once the object is closed
+    bool nextMember(std::string& key, bool& first);
+    bool beginArray();
+    //! Step to the next element, false once the array is closed
+    bool nextElement(bool& first);
+
+    bool readString(std::string& value);
+    bool readNumber(double& value);
+    bool readInteger(int64_t& value);
+    bool readBoolean(bool& value);
+    //! Read any value into a DOM, for members the schema leaves open
+    bool readValue(pbnjson::JValue& value);
+    bool skip();
+
+    //! True if only whitespace is left
+    bool atEnd();
+    bool failed() const { return m_failed; }
+
+private:
+    void skipSpace();
+    bool fail();
+    bool expect(char c);
+    bool scanNumber(const char*& end);
+    bool skipValue(int depth);
+
+    const char* m_pos;
+    bool m_failed;
+};
+
+#endif
@@ -0,0 +1,230 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "JsonWriter.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+JsonWriter::JsonWriter(size_t reserve)
+    : m_first(true)
+    , m_afterKey(false)
+{
+    m_buf.reserve(reserve);
+}
+
+void JsonWriter::clear()
+{
+    m_buf.clear();
+    m_first = true;
+    m_afterKey = false;
+}
+
+void JsonWriter::separate()
+{
+    if (m_afterKey)
+        m_afterKey = false;
+    else if (!m_first)
+        m_buf += ',';
+    m_first = false;
+}
+
+JsonWriter& JsonWriter::beginObject()
+{
+    separate();
+    m_buf += '{';
+    m_first = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject()
+{
+    m_buf += '}';
+    m_first = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray()
+{
+    separate();
+    m_buf += '[';
+    m_first = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray()
+{
+    m_buf += ']';
+    m_first = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(const char* name)
+{
+    separate();
+    string(name, strlen(name));
+    m_buf += ':';
+    m_afterKey = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(const std::string& name)
+{
+    separate();
+    string(name.data(), name.size());
+    m_buf += ':';
+    m_afterKey = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const char* str)
+{
+    separate();
+    string(str, strlen(str));
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const std::string& str)
+{
+    separate();
+    string(str.data(), str.size());
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool b)
+{
+    separate();
+    m_buf += b ? "true" : "false";
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(int n)
+{
+    return value(static_cast<int64_t>(n));
+}
+
+JsonWriter& JsonWriter::value(int64_t n)
+{
+    char buf[24];
+    int len = snprintf(buf, sizeof(buf), "%" PRId64, n);
+
+    separate();
+    m_buf.append(buf, len);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(double n)
+{
+    // JSON has no NaN or Infinity
+    if (!isfinite(n))
+    {
+        separate();
+        m_buf += "null";
+        return *this;
+    }
+
+    char buf[32];
+    int len = snprintf(buf, sizeof(buf), "%.17g", n);
+
+    separate();
+    m_buf.append(buf, len);
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const pbnjson::JValue& json)
+{
+    if (json.isObject())
+    {
+        beginObject();
+        for (auto child : json.children())
+            key(child.first.asString()).value(child.second);
+        return endObject();
+    }
+
+    if (json.isArray())
+    {
+        beginArray();
+        for (ssize_t index = 0; index < json.arraySize(); ++index)
+            value(json[index]);
+        return endArray();
+    }
+
+    if (json.isString())
+        return value(json.asString());
+
+    if (json.isBoolean())
+        return value(json.asBool());
+
+    if (json.isNumber())
+    {
+        int64_t integer = json.asNumber<int64_t>();
+        double real = json.asNumber<double>();
+        if (static_cast<double>(integer) == real)
+            return value(integer);
+        return value(real);
+    }
+
+    separate();
+    m_buf += "null";
+    return *this;
+}
+
+JsonWriter& JsonWriter::raw(const std::string& json)
+{
+    separate();
+    m_buf += json;
+    return *this;
+}
+
+void JsonWriter::string(const char* str, size_t len)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    m_buf += '"';
+
+    // Copy runs which need no escaping in one go
+    size_t run = 0;
+    for (size_t i = 0; i < len; ++i)
+    {
+        unsigned char c = static_cast<unsigned char>(str[i]);
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+
+        m_buf.append(str + run, i - run);
+        run = i + 1;
+
+        switch (c)
+        {
+        case '"':  m_buf += "\\\""; break;
+        case '\\': m_buf += "\\\\"; break;
+        case '\b': m_buf += "\\b"; break;
+        case '\f': m_buf += "\\f"; break;
+        case '\n': m_buf += "\\n"; break;
+        case '\r': m_buf += "\\r"; break;
+        case '\t': m_buf += "\\t"; break;
+        default:
+            m_buf += "\\u00";
+            m_buf += hex[c >> 4];
+            m_buf += hex[c & 0xf];
+            break;
+        }
+    }
+    m_buf.append(str + run, len - run);
+
+    m_buf += '"';
+}
@@ -0,0 +1,74 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __JSONWRITER_H__
+#define __JSONWRITER_H__
+
+#include <string>
+#include <stdint.h>
+#include <pbnjson.hpp>
+
+/*! Writes JSON text straight into a buffer, for replies and posts which
+ * don't need a DOM. Commas are inserted automatically; the caller is
+ * responsible for balancing begin/end and for following key() with a value.
+ * clear() keeps the buffer's capacity, so a writer kept around for a hot
+ * path stops allocating once it has seen its largest payload.
+ *
+ *     JsonWriter writer;
+ *     writer.beginObject().member("returnValue", true).endObject();
+ *     LSMessageReply(handle, msg, writer.c_str(), &lserror);
+ */
+class JsonWriter
+{
+public:
+    explicit JsonWriter(size_t reserve = 256);
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+
+    JsonWriter& key(const char* name);
+    JsonWriter& key(const std::string& name);
+
+    JsonWriter& value(const char* str);
+    JsonWriter& value(const std::string& str);
+    JsonWriter& value(bool b);
+    JsonWriter& value(int n);
+    JsonWriter& value(int64_t n);
+    JsonWriter& value(double n);
+    //! Write a DOM value, e.g. a row read from db8
+    JsonWriter& value(const pbnjson::JValue& json);
+    //! Write text which already is a serialized JSON value
+    JsonWriter& raw(const std::string& json);
+
+    template <typename T>
+    JsonWriter& member(const char* name, const T& v) { return key(name).value(v); }
+
+    const std::string& str() const { return m_buf; }
+    const char* c_str() const { return m_buf.c_str(); }
+    void clear();
+
+private:
+    void separate();
+    void string(const char* str, size_t len);
+
+    std::string m_buf;
+    bool m_first;       // nothing written yet in the current object or array
+    bool m_afterKey;
+};
+
+#endif
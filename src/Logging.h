@@ -40,6 +40,7 @@ PmLogContext GetNotificationPmLogContext();
 
 #define MSGID_SETTINGS_DATA_EMPTY "SETTINGS_EMPTY"
 #define MSGID_SETTINGS_FILE_LOAD_FAILED "SETTINGSFILE_FAIL"
+#define MSGID_SETTINGS_INVALID_VALUE "SETTINGS_INVALID_VALUE"
 #define MSGID_SETTINGS_GETSYSTEMSETTINGS_OPTION_FAILED "SETTINGS_GETSYSTEMSETTINGS_OPTION_FAILED"
 #define MSGID_SETTINGS_OPTION_COUNTRY "SETTINGS_OPTION_COUNTRY"
 #define MSGID_SETTINGS_OPTION_STOREMODE "SETTINGS_OPTION_STOREMODE"
@@ -118,6 +119,12 @@ PmLogContext GetNotificationPmLogContext();
 #define MSGID_FAILED_TO_RESPOND "LSMESSAGE_FAILED_TO_RESPOND"
 
 #define MSGID_NOTIFICATIONMGR "notificationmgr"
+#define MSGID_SCHEMA_LOADED "SCHEMA_LOADED"
+#define MSGID_SCHEMA_LOAD_FAIL "SCHEMA_LOAD_FAIL"
+#define MSGID_SCHEMA_GENERATED "SCHEMA_GENERATED"
+#define MSGID_PENDING_QUEUE_OVERFLOW "PENDING_QUEUE_OVERFLOW"
+#define MSGID_RATE_LIMITED "RATE_LIMITED"
+#define MSGID_TOAST_COUNT_DRIFT "TOAST_COUNT_DRIFT"
 
 #define MSGID_PATH_MISSING "PATH_MISSING"
 #define MSGID_XML_PATH     "XML_PATH"
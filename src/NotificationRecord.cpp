@@ -0,0 +1,150 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "NotificationRecord.h"
+
+#include <JUtil.h>
+
+#define APPMGR_LAUNCH_CALL "palm://com.webos.applicationManager/"
+#define APPMGR_LAUNCH_METHOD "launch"
+
+// Keys, punctuation and the fixed size fields of a toast payload
+#define TOAST_RECORD_OVERHEAD 384
+
+ToastRecord::ToastRecord()
+    : displayId(0)
+    , onlyToast(true)
+    , isSysReq(false)
+    , isCradleReq(false)
+    , expire(0)
+    , trackRead(false)
+    , launch(false)
+{
+}
+
+size_t ToastRecord::bytes() const
+{
+    if (!m_body.empty())
+        return m_body.size();
+
+    size_t size = TOAST_RECORD_OVERHEAD + sourceId.size() + iconUrl.size() + iconPath.size()
+                + message.size() + title.size() + timestamp.size() + timesource.size()
+                + type.size() + collapseKey.size() + user.size() + launchId.size() + launchTarget.size();
+
+    for (const std::string& image : images)
+        size += image.size() + 16;
+
+    // Caller supplied and unbounded, worth the serialization on this cold path
+    if (!launchParams.isNull())
+        size += JUtil::jsonToString(launchParams).size();
+
+    return size;
+}
+
+pbnjson::JValue ToastRecord::toJson() const
+{
+    pbnjson::JValue json = pbnjson::Object();
+    json.put("sourceId", sourceId);
+    json.put("displayId", displayId);
+    json.put("iconUrl", iconUrl);
+    json.put("iconPath", iconPath);
+    json.put("message", message);
+    json.put("title", title);
+    json.put("timestamp", timestamp);
+    if (!timesource.empty())
+        json.put("timesource", timesource);
+    json.put("type", type);
+    if (!collapseKey.empty())
+        json.put("collapseKey", collapseKey);
+    json.put("onlyToast", onlyToast);
+    json.put("isSysReq", isSysReq);
+    json.put("isCradleReq", isCradleReq);
+
+    if (expire != 0)
+        json.put("schedule", pbnjson::JObject{{"expire", expire}});
+
+    if (!images.empty())
+    {
+        pbnjson::JValue array = pbnjson::Array();
+        for (const std::string& image : images)
+            array.append(pbnjson::JObject{{"uri", image}});
+        json.put("images", array);
+    }
+
+    if (trackRead)
+    {
+        json.put("readStatus", false);
+        json.put("user", user);
+    }
+
+    pbnjson::JValue action = pbnjson::Object();
+    if (launch)
+    {
+        pbnjson::JValue launchParamsJson = pbnjson::Object();
+        if (!launchId.empty())
+        {
+            launchParamsJson.put("id", launchId);
+            if (!launchParams.isNull())
+                launchParamsJson.put("params", launchParams);
+        }
+        else
+        {
+            launchParamsJson.put("target", launchTarget);
+        }
+
+        action.put("serviceURI", APPMGR_LAUNCH_CALL);
+        action.put("serviceMethod", APPMGR_LAUNCH_METHOD);
+        action.put("launchParams", launchParamsJson);
+    }
+    json.put("action", action);
+
+    return json;
+}
+
+const std::string& ToastRecord::body() const
+{
+    if (m_body.empty())
+        m_body = JUtil::jsonToString(toJson());
+    return m_body;
+}
+
+const std::string& ToastRecord::body(const pbnjson::JValue& json) const
+{
+    if (m_body.empty())
+        m_body = JUtil::jsonToString(json);
+    return m_body;
+}
+
+AlertRecord::AlertRecord()
+    : isSysReq(false)
+{
+}
+
+size_t AlertRecord::bytes() const
+{
+    return 64 + action.size() + timestamp.size() + (alertInfo.isNull() ? 0 : JUtil::jsonToString(alertInfo).size());
+}
+
+pbnjson::JValue AlertRecord::toJson() const
+{
+    pbnjson::JValue json = pbnjson::Object();
+    json.put("alertAction", action);
+    if (!alertInfo.isNull())
+        json.put("alertInfo", alertInfo);
+    if (!timestamp.empty())
+        json.put("timestamp", timestamp);
+    return json;
+}
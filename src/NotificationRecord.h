@@ -0,0 +1,99 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __NOTIFICATIONRECORD_H__
+#define __NOTIFICATIONRECORD_H__
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <pbnjson.hpp>
+
+/*! A validated toast on its way to the history and the UI.
+ * Records are move-only so a toast is never copied between the request
+ * handler, the pending queue and delivery. toJson() builds the payload
+ * and is called once for each destination.
+ */
+struct ToastRecord
+{
+    ToastRecord();
+    ToastRecord(ToastRecord&&) = default;
+    ToastRecord& operator=(ToastRecord&&) = default;
+    ToastRecord(const ToastRecord&) = delete;
+    ToastRecord& operator=(const ToastRecord&) = delete;
+
+    std::string sourceId;
+    int displayId;
+    std::string iconUrl;
+    std::string iconPath;
+    std::string message;
+    std::string title;
+    std::string timestamp;
+    std::string timesource;         // empty until the system time is synced
+    std::string type;
+    std::string collapseKey;        // replaces the toast of the same source and key, empty if none
+    bool onlyToast;
+    bool isSysReq;
+    bool isCradleReq;
+    int64_t expire;                 // 0 if the toast never expires
+    std::vector<std::string> images;
+
+    bool trackRead;                 // has readStatus and user, false for noaction toasts
+    std::string user;
+
+    bool launch;                    // onclick launches an app
+    std::string launchId;           // app to launch, or
+    std::string launchTarget;       // target to launch
+    pbnjson::JValue launchParams;   // caller's onclick params, null if none
+
+    //! Approximate size of the payload, for the pending queue budget
+    size_t bytes() const;
+    pbnjson::JValue toJson() const;
+
+    /*! toJson() serialized. Generated on first use and shared by the history
+     * write and the subscription post, so don't modify a record after that.
+     */
+    const std::string& body() const;
+    //! Same as body(), json must be what toJson() returned
+    const std::string& body(const pbnjson::JValue& json) const;
+
+private:
+    mutable std::string m_body;
+};
+
+/*! An alert open, close or closeAll request for the alert UI.
+ * alertInfo is kept as JSON because most of it (buttons, actions and their
+ * params) is passed through from the caller.
+ */
+struct AlertRecord
+{
+    AlertRecord();
+    AlertRecord(AlertRecord&&) = default;
+    AlertRecord& operator=(AlertRecord&&) = default;
+    AlertRecord(const AlertRecord&) = delete;
+    AlertRecord& operator=(const AlertRecord&) = delete;
+
+    std::string action;             // "open", "close" or "closeAll"
+    std::string sourceId;
+    bool isSysReq;
+    std::string timestamp;          // set for "open"
+    pbnjson::JValue alertInfo;      // null for "closeAll"
+
+    size_t bytes() const;
+    pbnjson::JValue toJson() const;
+};
+
+#endif
@@ -31,6 +31,10 @@
 #include "SystemTime.h"
 #include "JsonParser.h"
 #include "PincodeValidator.h"
+#include "IconCache.h"
+#include "RateLimiter.h"
+#include "JsonWriter.h"
+#include "RequestParsers.h"
 
 #include <string>
 #include <Utils.h>
@@ -38,30 +42,31 @@
 #include <Logging.h>
 #include <pbnjson.hpp>
 #include <vector>
+#include <set>
+#include <algorithm>
 #include "sax_parser.h"
 
 
-#define APPMGR_LAUNCH_CALL "palm://com.webos.applicationManager/"
 #define SETTING_API_CALL(handle, uri, params, ...) \
     LSCallOneReply(handle, uri, params, ##__VA_ARGS__); \
     LOG_DEBUG("%s: SETTING_ call %s %s", __FUNCTION__, uri, params)
-#define APPMGR_LAUNCH_METHOD "launch"
 #define PRIVILEGED_SOURCE "com.lge.service.remotenotification"
 #define PRIVILEGED_APP_SOURCE "com.lge.app.remotenotification"
-#define PRIVILEGED_SYSTEM_UI_SOURCE "com.webos.surfacemanager"
-#define PRIVILEGED_SYSTEM_UI_NOTI "com.webos.app.notification"
 #define PRIVILEGED_CLOUDLINK_SOURCE "com.lge.service.cloudlink"
 #define ALERTAPP "com.webos.app.commercial.alert"
+#define PENDING_FLUSH_BATCH 8
+#define PENDING_FLUSH_BUDGET_US 4000
+#define TOAST_MESSAGE_MAX_CHARS 60
 
 static NotificationService* s_instance = 0;
 std::string NotificationService::m_user_name = "guest";
 int NotificationService::m_display_id = 0;
-NotificationService::toastCount NotificationService::toastCountVector[] = {};
 
 //LS2 Functions
 static LSMethod s_methods[] =
 {
     { "createToast", NotificationService::cb_createToast},
+    { "createToasts", NotificationService::cb_createToasts},
     { "createAlert", NotificationService::cb_createAlert},
     { "closeToast", NotificationService::cb_closeToast},
     { "closeAlert", NotificationService::cb_closeAlert},
@@ -75,13 +80,15 @@ static LSMethod s_methods[] =
     { "getToastCount", NotificationService::cb_getToastCount},
     { "getToastList", NotificationService::cb_getToastList},
     { "setToastStatus", NotificationService::cb_setToastStatus},
+    { "getStats", NotificationService::cb_getStats},
     {0, 0}
 };
 
 using namespace std::placeholders;
 
 NotificationService::NotificationService()
-    : UI_ENABLED(false), BLOCK_ALERT_NOTIFICATION(false), BLOCK_TOAST_NOTIFICATION(false)
+    : alertMsgQueue("alert"), UI_ENABLED(false), BLOCK_ALERT_NOTIFICATION(false), BLOCK_TOAST_NOTIFICATION(false)
+    , notiMsgQueue("notification"), toastMsgQueue("toast"), m_flush(), m_countPost()
 {
     m_service = 0;
     if (UiStatus::instance().alert())
@@ -108,6 +115,9 @@ bool NotificationService::attach(GMainLoop *gml)
 
 	LSErrorSafe lse;
 
+	// Compile the schemas while the service registers
+	JUtil::instance().preloadSchemas();
+
 	if(!LSRegister(get_service_name(), &m_service, &lse))
 	{
 		LOG_ERROR(MSGID_SERVICE_REG_ERR, 2, PMLOGKS("SERVICE_NAME", get_service_name()), PMLOGKS("ERROR_MESSAGE", lse.message), "Failed to register service in %s", __PRETTY_FUNCTION__);
@@ -120,6 +130,9 @@ bool NotificationService::attach(GMainLoop *gml)
 		return false;
 	}
 
+	JUtil::instance().waitForSchemas();
+	JUtil::instance().watchSchemas();
+
 	if(!LSGmainAttach(m_service, gml, &lse))
 	{
 		LOG_ERROR(MSGID_SERVICE_ATTACH_ERR, 2, PMLOGKS("SERVICE_NAME", get_service_name()), PMLOGKS("ERROR_MESSAGE", lse.message), "Failed to attach error in %s", __PRETTY_FUNCTION__);
@@ -136,6 +149,7 @@ bool NotificationService::attach(GMainLoop *gml)
 
 	AppList::instance();
 	Settings::instance();
+	applyPendingQueueLimits();
 
 	SystemTime::instance().startSync();
 	History::instance();
@@ -146,6 +160,24 @@ bool NotificationService::attach(GMainLoop *gml)
 void NotificationService::detach()
 {
 	LSErrorSafe lse;
+
+	// Pending history writes need the handle, so send them before it goes away.
+	// A history that was never created has none, don't start its db8 loads now.
+	if (History::hasInstance())
+		History::instance()->flush();
+
+	if (m_flush.source)
+	{
+		g_source_remove(m_flush.source);
+		m_flush.source = 0;
+	}
+
+	if (m_countPost.timer)
+	{
+		g_source_remove(m_countPost.timer);
+		m_countPost.timer = 0;
+	}
+
 	if(!LSUnregister(m_service, &lse))
 	{
 		LOG_ERROR(MSGID_SERVICE_DETACH_ERR, 2, PMLOGKS("SERVICE_NAME", get_service_name()), PMLOGKS("ERROR_MESSAGE", lse.message), "Failed to detach error in %s", __PRETTY_FUNCTION__);
@@ -167,18 +199,52 @@ const char* NotificationService::getServiceName(LSMessage *msg)
 	return caller;
 }
 
-void NotificationService::pushNotiMsgQueue(pbnjson::JValue payload, bool remove, bool removeAll) {
-    LOG_WARNING("notificationmgr", 0, "[%s:%d] %s %d %d", __FUNCTION__, __LINE__, JUtil::jsonToString(payload).c_str(), remove, removeAll);
-    notiMsgItem *item = new NotiMsgItem(payload, remove, removeAll);
-    notiMsgQueue.push(item);
+bool NotificationService::pushNotiMsgQueue(pbnjson::JValue payload, bool remove, bool removeAll) {
+    std::string serialized = JUtil::jsonToString(payload);
+    LOG_WARNING("notificationmgr", 0, "[%s:%d] %s %d %d", __FUNCTION__, __LINE__, serialized.c_str(), remove, removeAll);
+
+    // Removals must never be coalesced away
+    std::string source = (remove || removeAll) ? "" : payload["sourceId"].asString();
+    bool isSysReq = payload["isSysReq"].asBool();
+
+    NotiMsgItem item = {std::move(payload), remove, removeAll};
+    return notiMsgQueue.push(std::move(item), isSysReq, source, serialized.size());
 }
 
-void NotificationService::popNotiMsgQueue() {
-    LOG_WARNING("notificationmgr", 0, "[%s:%d]", __FUNCTION__, __LINE__);
-    if(!notiMsgQueue.empty()) {
-        delete notiMsgQueue.front();
-        notiMsgQueue.pop();
-    }
+bool NotificationService::pushAlertMsgQueue(AlertRecord alert)
+{
+    bool isSysReq = alert.isSysReq;
+    std::string source = alert.sourceId;
+    size_t bytes = alert.bytes();
+    return alertMsgQueue.push(std::move(alert), isSysReq, source, bytes);
+}
+
+bool NotificationService::pushToastMsgQueue(ToastRecord toast)
+{
+    bool isSysReq = toast.isSysReq;
+    std::string source = toast.sourceId;
+    size_t bytes = toast.bytes();
+    // A queued toast is superseded by a newer one of the same source and collapseKey
+    std::string collapseKey = toast.collapseKey.empty() ? "" : source + '\n' + toast.collapseKey;
+    return toastMsgQueue.push(std::move(toast), isSysReq, source, bytes, collapseKey);
+}
+
+void NotificationService::applyPendingQueueLimits()
+{
+    Settings* settings = Settings::instance();
+
+    PendingQueue<ToastRecord>::Policy policy = PendingQueue<ToastRecord>::DROP_LOWEST_PRIORITY;
+    if (settings->getPendingQueuePolicy() == "dropOldest")
+        policy = PendingQueue<ToastRecord>::DROP_OLDEST;
+    else if (settings->getPendingQueuePolicy() == "coalesceSource")
+        policy = PendingQueue<ToastRecord>::COALESCE_SOURCE;
+
+    size_t maxItems = settings->getPendingQueueMaxItems();
+    size_t maxBytes = settings->getPendingQueueMaxBytes();
+
+    toastMsgQueue.setLimits(maxItems, maxBytes, policy);
+    alertMsgQueue.setLimits(maxItems, maxBytes, static_cast<PendingQueue<AlertRecord>::Policy>(policy));
+    notiMsgQueue.setLimits(maxItems, maxBytes, static_cast<PendingQueue<NotiMsgItem>::Policy>(policy));
 }
 
 //->Start of API documentation comment block
@@ -187,12 +253,14 @@ void NotificationService::popNotiMsgQueue() {
 @{
 @section com_webos_notification_getNotification getNotification
 
-System UI subscribes to this method and show notification on the screen
+System UI subscribes to this method and show notification on the screen.
+The same handler serves getToastNotification and getAlertNotification.
 
 @par Parameters
 Name | Required | Type | Description
 -----|----------|------|------------
 subscribe | yes  | Boolean | True
+displayId | no   | Number | getToastNotification only: receive just the toasts of this display. Without it every toast is received. getToastCount subscriptions are per display the same way.
 
 @par Returns(Call)
 None
@@ -214,21 +282,25 @@ bool NotificationService::cb_getNotification(LSHandle* lshandle, LSMessage *msg,
 	bool subscribed = false;
 	bool success = false;
 	bool subscribeUI = false;
-    std::string checkCaller = "";
-    std::string caller = LSUtils::getCallerId(msg);
-    if (caller.empty())
-        caller = "Anonymous";
-    // Check for Caller Id
-    checkCaller = Utils::extractSourceIdFromCaller(caller);
-    LOG_DEBUG("cb_getNotification Caller = %s", checkCaller.c_str());
+    const CallerProfile& caller = CallerProfiles::instance().lookup(msg);
+    LOG_DEBUG("cb_getNotification Caller = %s", caller.sourceId.c_str());
 
-    if ((std::string(checkCaller).find(PRIVILEGED_SYSTEM_UI_SOURCE) != std::string::npos)
-       ||(std::string(checkCaller).find(PRIVILEGED_SYSTEM_UI_NOTI) != std::string::npos))
+    if (caller.systemUi)
     {
         subscribeUI = true;
         if(LSMessageIsSubscription(msg))
 		{
-			success = LSSubscriptionProcess(lshandle, msg, &subscribed, &lserror);
+			std::string method = LSUtils::getMethod(msg);
+			if (method == "getToastNotification")
+			{
+				pbnjson::JValue request = JUtil::parse(LSMessageGetPayload(msg), "", nullptr);
+				int displayId = request["displayId"].isNumber() ? request["displayId"].asNumber<int>() : -1;
+				success = subscribed = subscribeDisplay(lshandle, msg, "getToastNotification", displayId, &lserror);
+			}
+			else
+			{
+				success = LSSubscriptionProcess(lshandle, msg, &subscribed, &lserror);
+			}
 		}
     }
 
@@ -265,56 +337,57 @@ bool NotificationService::cb_getToastCount(LSHandle* lshandle, LSMessage *msg, v
 
     bool subscribed = false;
     bool subscribeUI = false;
-    std::string checkCaller="";
-    std::string caller = LSUtils::getCallerId(msg);
-    if (caller.empty())
-        caller = "Anonymous";
-    // Check for Caller Id of notification app
-    checkCaller = Utils::extractSourceIdFromCaller(caller);
+    const CallerProfile& caller = CallerProfiles::instance().lookup(msg);
     std::string method = LSUtils::getMethod(msg);
-    LOG_DEBUG("cb_getToastCount Caller = %s", checkCaller.c_str());
+    LOG_DEBUG("cb_getToastCount Caller = %s", caller.sourceId.c_str());
 
     pbnjson::JValue request = pbnjson::Object();
     request = JUtil::parse(LSMessageGetPayload(msg), "", nullptr);
 
-    if ((std::string(checkCaller).find(PRIVILEGED_SYSTEM_UI_SOURCE) != std::string::npos )
-       ||(std::string(checkCaller).find(PRIVILEGED_SYSTEM_UI_NOTI) != std::string::npos))
+    // Only a valid request is subscribed, an error reply must not leave a subscription behind
+    int displayId = request["displayId"].isNumber() ? request["displayId"].asNumber<int>() : -1;
+    std::string errorText;
+    if (!request["displayId"].isNumber())
+        errorText = "displayId should be a number";
+    else if (!DisplayTable::isValid(displayId))
+        errorText = DisplayTable::invalidText();
+
+    if (caller.systemUi)
     {
         subscribeUI = true;
 
-        if (LSMessageIsSubscription(msg))
-            subscribed = LSSubscriptionProcess(lshandle, msg, &subscribed, &lserror);
+        if (LSMessageIsSubscription(msg) && errorText.empty())
+            subscribed = subscribeDisplay(lshandle, msg, "getToastCount", displayId, &lserror);
     }
 
     LOG_INFO(MSGID_SVC_GET_NOTIFICATION, 4,
-        PMLOGKS("caller", checkCaller.c_str()),
+        PMLOGKS("caller", caller.sourceId.c_str()),
         PMLOGKS("method", method.c_str()),
         PMLOGKS("subscribe", LSMessageIsSubscription(msg) ? "true" : "false"),
         PMLOGKS("subscribed", subscribed ? "true" : "false"), " ");
 
-    pbnjson::JValue json = pbnjson::Object();
+    static JsonWriter writer;
+    writer.clear();
+    writer.beginObject();
 
-    if (!request["displayId"].isNumber())
+    if (!errorText.empty())
     {
-        json.put("returnValue", false);
-        json.put("errorText", "displayId should be a number");
+        writer.member("returnValue", false);
+        writer.member("errorText", errorText);
     }
     else
     {
-        int displayId = request["displayId"].asNumber<int>();
-        if (displayId != 0 && displayId != 1)
-        {
-            json.put("returnValue", false);
-            json.put("errorText", "Invalid displayId. Must be 0 or 1");
-        }
-        else
-        {
-            json.put("readCount", toastCountVector[displayId].readCount);
-            json.put("unreadCount", toastCountVector[displayId].unreadCount);
-            json.put("returnValue", true);
-            json.put("subscribed", subscribed);
-        }
+        DisplayState* display = DisplayTable::instance().get(displayId);
+        if (subscribeUI && subscribed)
+            display->subscribers++;
+
+        writer.member("readCount", display->readCount);
+        writer.member("unreadCount", display->unreadCount);
+        writer.member("sequence", static_cast<int64_t>(display->countSequence));
+        writer.member("returnValue", true);
+        writer.member("subscribed", subscribed);
     }
+    writer.endObject();
 
     if (subscribeUI && subscribed)
     {
@@ -328,9 +401,7 @@ bool NotificationService::cb_getToastCount(LSHandle* lshandle, LSMessage *msg, v
         NotificationService::instance()->processNotiMsgQueue();
     }
 
-    std::string result = pbnjson::JGenerator::serialize(json, pbnjson::JSchemaFragment("{}"));
-
-    if(!LSMessageReply(lshandle, msg, result.c_str(), &lserror))
+    if(!LSMessageReply(lshandle, msg, writer.c_str(), &lserror))
     {
         return false;
     }
@@ -345,10 +416,25 @@ bool NotificationService::cb_SubscriptionCanceled(LSHandle *lshandle, LSMessage
 
 	val = LSMessageGetKind(msg);
 	std::string kind = val ? val : std::string("");
-	unsigned int subscribers = LSSubscriptionGetHandleSubscribersCount(lshandle, kind.c_str());
+	unsigned int subscribers = (method == "getToastNotification")
+		? subscriberCount(lshandle, "getToastNotification")
+		: LSSubscriptionGetHandleSubscribersCount(lshandle, kind.c_str());
 
     LOG_DEBUG("cb_SubscriptionCanceled: %s, subscribers:%u", method.c_str(), subscribers);
 
+	if (method == "getToastCount")
+	{
+		// Mirrors cb_getToastCount, which only counts subscriptions with a valid displayId
+		pbnjson::JValue request = JUtil::parse(LSMessageGetPayload(msg), "", nullptr);
+		if (!request["displayId"].isNumber() || !DisplayTable::isValid(request["displayId"].asNumber<int>()))
+			return true;
+
+		DisplayState* display = DisplayTable::instance().get(request["displayId"].asNumber<int>());
+		if (display && display->subscribers > 0)
+			display->subscribers--;
+		return true;
+	}
+
 	if (method == "getToastNotification" ||
 		method == "getAlertNotification")
         {
@@ -375,13 +461,14 @@ Name | Required | Type | Description
 -----|----------|------|------------
 sourceId | yes  | String | It should be App or Service Id that creates the toast
 iconUrl  | no   | String | File path to icon. The path should be local to device
-message  | yes  | String | Toast message which can be upto 60 characters long
+message  | yes  | String | Toast message which can be upto 60 characters long, longer messages are truncated
 onclick  | no   | Object | Defines the toast action
 noaction | no   | Boolean | Indicates no action is required.
 stale    | no   | Boolean | Indicates toast is old and doesn't need to be displayed
 persistent | no | Boolean | Indicates toast is saved on history
 schedule | no   | Object | Defines the persistent message schedule
 type     | no   | String | Defines toast type
+collapseKey | no | String | A toast with the sourceId and collapseKey of an earlier toast replaces it. It keeps the earlier toastId, updates its history record and replaces it if it is still queued.
 extra    | no   | Object | Defines extra resources
 
 @par Returns(Call)
@@ -397,208 +484,146 @@ None
 */
 //->End of API documentation comment block
 
-bool NotificationService::cb_createToast(LSHandle* lshandle, LSMessage *msg, void *user_data)
+template <typename Request>
+bool NotificationService::buildToast(const CallerProfile& caller, const Request& request, ToastRequest& toast, std::string& errText,
+                                     bool batch)
 {
     int displayId = 0;
-    LSErrorSafe lserror;
 
-    bool success = false;
-
-    std::string errText;
-    std::string sourceId;
-    std::string message;
-    std::string target;
-    std::string launchAppId;
     std::string iconPath;
-    bool noaction = false;
-    bool staleMsg = false;
-    bool persistentMsg = false;
+    std::string iconUrl;
+    std::string appIcon;
+    bool appExist = false;
     bool privilegedSource = false;
-    std::string title;
-    std::string type;
-    bool isSysReq = false;
-    bool isCradleReq = false;
     bool ignoreDisable = false;
 
-    pbnjson::JValue request;
-    pbnjson::JValue postCreateToast;
-    pbnjson::JValue onclick;
-    pbnjson::JValue action;
-    pbnjson::JValue appMgrParams;
-
-    pbnjson::JValue reqSchedule;
-    pbnjson::JValue schedule;
-
-    pbnjson::JValue reqExtra;
-
-    std::string timestamp;
-
-    JUtil::Error error;
-
-    std::string errorText;
-    pbnjson::JValue getActiveUserParams;
-    pbnjson::JValue postToastCount = pbnjson::Object();
-    bool toastCountStatus = false;
-    int readCount, unreadCount = 0;
-
-    std::string caller = LSUtils::getCallerId(msg);
-    if (caller.empty())
-    {
-        LOG_WARNING(MSGID_CT_CALLERID_MISSING, 0, "Caller ID is missing in %s", __PRETTY_FUNCTION__);
-        errText = "Unknown Source";
-        goto Done;
-    }
-    LOG_WARNING(MSGID_NOTIFICATIONMGR, 0, "[%s:%d] Caller: %s", __FUNCTION__, __LINE__, caller.c_str());
-
-    request = JUtil::parse(LSMessageGetPayload(msg), "createToast", &error);
+    ToastRecord& record = toast.record;
 
-    if (request.isNull())
-    {
-        LOG_WARNING(MSGID_CT_PARSE_FAIL, 0, "Message parsing error in %s", __PRETTY_FUNCTION__);
-        errText = "Message is not parsed";
-        goto Done;
-    }
+    toast.valid = false;
+    toast.staleMsg = false;
+    toast.persistentMsg = false;
 
-    if (Settings::instance()->isPrivilegedSource(caller) || Settings::instance()->isPartOfAggregators(std::string(caller)))
-    {
-        privilegedSource = true;
-    }
+    privilegedSource = caller.trusted();
 
-    m_display_id = request["displayId"].asNumber<int>();
-    sourceId = request["sourceId"].asString();
-    if (request.hasKey("displayId"))
+    m_display_id = static_cast<int>(request.displayId.value);
+    toast.sourceId = request.sourceId.value;
+    if (request.displayId.set)
     {
-        displayId = request["displayId"].asNumber<int>();
+        displayId = static_cast<int>(request.displayId.value);
         LOG_DEBUG("Key Display ID: %d", displayId);
         // LOG_INFO("port Key Display ID: %d", displayId);
         LOG_WARNING(MSGID_NOTIFICATIONMGR, 0, "port [%s:%d] displayId: %d", __FUNCTION__, __LINE__, displayId);
     }
+    record.displayId = displayId;
 
-    if (displayId >= 0)
-        toastCountVector[displayId].unreadCount++;
+    // A negative displayId is not counted, as before
+    if (displayId >= 0 && !DisplayTable::isValid(displayId))
+    {
+        errText = DisplayTable::invalidText();
+        return false;
+    }
 
-    if (sourceId.length() == 0)
+    if (toast.sourceId.length() == 0)
     {
-        sourceId = Utils::extractSourceIdFromCaller(caller);
+        toast.sourceId = caller.sourceId;
     }
 
     // SourceId and Caller should match for non-privileged apps
     if (!privilegedSource)
     {
-        if (std::string(caller).find(sourceId, 0) == std::string::npos)
+        if (caller.callerId.find(toast.sourceId, 0) == std::string::npos)
         {
             LOG_WARNING(MSGID_CT_SOURCEID_INVALID, 0, "Source ID is invalid in %s", __PRETTY_FUNCTION__);
             errText = "Invalid source id specified";
-            goto Done;
+            return false;
         }
     }
 
-    message = request["message"].asString();
-    if (message.length() == 0)
+    // Clean up control characters and broken UTF-8, and keep the documented
+    // message length. Done first, a message of control characters is blank.
+    toast.message = request.message.value;
+    Utils::sanitizeText(toast.message, TOAST_MESSAGE_MAX_CHARS);
+    if (toast.message.find_first_not_of(' ') == std::string::npos)
     {
         LOG_WARNING(MSGID_CT_MSG_EMPTY, 0, "Empty message is given in %s", __PRETTY_FUNCTION__);
         errText = "Message can't be empty";
-        goto Done;
+        return false;
     }
 
-    title = request["title"].asString();
+    record.title = request.title.value;
+    Utils::sanitizeText(record.title);
 
-    ignoreDisable = request["ignoreDisable"].asBool();
+    ignoreDisable = request.ignoreDisable.value;
 
     if (!ignoreDisable && UiStatus::instance().toast() && !(UiStatus::instance().toast())->isEnabled(UiStatus::ENABLE_ALL & ~UiStatus::ENABLE_UI))
     {
         errText = "Toast is blocked by " + (UiStatus::instance().toast())->reason();
-        goto Done;
+        return false;
     }
 
-    postCreateToast = pbnjson::Object();
-    postCreateToast.put("sourceId", sourceId);
-    postCreateToast.put("displayId", displayId);
-    action = pbnjson::Object();
-
-    if (Settings::instance()->isPrivilegedSource(caller))
+    if (toast.sourceId == caller.sourceId)
     {
-        iconPath = request["iconUrl"].asString();
+        appExist = caller.appExist;
+        appIcon = caller.appIcon;
     }
     else
     {
-        iconPath = AppList::instance()->getIcon(sourceId);
+        appExist = AppList::instance()->lookup(toast.sourceId, &appIcon);
     }
 
-    if (iconPath.length() != 0 && Utils::verifyFileExist(iconPath.c_str()))
+    if (caller.privileged)
     {
-        postCreateToast.put("iconUrl", "file://" + iconPath);
-        postCreateToast.put("iconPath", iconPath);
+        iconPath = request.iconUrl.value;
     }
     else
     {
-        postCreateToast.put("iconUrl", "file://" + Settings::instance()->getDefaultIcon("toast"));
-        postCreateToast.put("iconPath", Settings::instance()->getDefaultIcon("toast"));
-    }
-
-    // Remove if there is any space character except ' '
-    std::replace_if(message.begin(), message.end(), Utils::isEscapeChar, ' ');
-    postCreateToast.put("message", message);
-
-    std::replace_if(title.begin(), title.end(), Utils::isEscapeChar, ' ');
-    postCreateToast.put("title", title);
-
-    staleMsg = request["stale"].asBool();
-    persistentMsg = request["persistent"].asBool();
-
-    Utils::createTimestamp(timestamp);
-    postCreateToast.put("timestamp", timestamp);
-    if (SystemTime::instance().isSynced())
-        postCreateToast.put("timesource", SystemTime::instance().getTimeSource());
-
-    postCreateToast.put("type", request["type"].asString());
-
-    if (!staleMsg && UiStatus::instance().toast() && !(UiStatus::instance().toast())->isEnabled(UiStatus::ENABLE_UI))
-    {
-        errText = "UI is not yet ready";
-        goto Done;
+        iconPath = appIcon;
     }
 
-    if (request["onlyToast"].isNull())
+    if (IconCache::instance().resolve(iconPath, &iconUrl))
     {
-        postCreateToast.put("onlyToast", true);
+        record.iconUrl = std::move(iconUrl);
+        record.iconPath = std::move(iconPath);
     }
     else
     {
-        postCreateToast.put("onlyToast", request["onlyToast"].asBool());
+        record.iconPath = Settings::instance()->getDefaultIcon("toast");
+        record.iconUrl = "file://" + record.iconPath;
     }
 
-    if (request["isSysReq"].isNull())
-    {
-        postCreateToast.put("isSysReq", isSysReq);
-    }
-    else
-    {
-        postCreateToast.put("isSysReq", request["isSysReq"].asBool());
-    }
+    toast.staleMsg = request.stale.value;
+    toast.persistentMsg = request.persistent.value;
 
-    if (request["isCradleReq"].isNull())
-    {
-        postCreateToast.put("isCradleReq", isCradleReq);
-    }
-    else
+    Utils::createTimestamp(record.timestamp);
+    if (SystemTime::instance().isSynced())
+        record.timesource = SystemTime::instance().getTimeSource();
+
+    record.type = request.type.value;
+    record.collapseKey = request.collapseKey.value;
+
+    if (!toast.staleMsg && UiStatus::instance().toast() && !(UiStatus::instance().toast())->isEnabled(UiStatus::ENABLE_UI))
     {
-        postCreateToast.put("isCradleReq", request["isCradleReq"].asBool());
+        errText = "UI is not yet ready";
+        return false;
     }
 
-    reqSchedule = request["schedule"];
-    if (reqSchedule.isObject())
+    if (request.onlyToast.set)
+        record.onlyToast = request.onlyToast.value;
+    if (request.isSysReq.set)
+        record.isSysReq = request.isSysReq.value;
+    if (request.isCradleReq.set)
+        record.isCradleReq = request.isCradleReq.value;
+
+    if (request.schedule.set)
     {
-        int64_t expire = 0;
-        if (reqSchedule.hasKey("expire"))
-            expire = reqSchedule["expire"].asNumber<int64_t>();
+        int64_t expire = static_cast<int64_t>(request.schedule.value.expire.value);
 
         if (expire != 0)
         {
             if (!SystemTime::instance().isSynced())
             {
                 errText = std::string("System time is not synced yet");
-                goto Done;
+                return false;
             }
 
             time_t currTime = time(NULL);
@@ -609,156 +634,367 @@ bool NotificationService::cb_createToast(LSHandle* lshandle, LSMessage *msg, voi
                     + std::string(") < curtime(")
                     + Utils::toString(currTime)
                     + std::string(")");
-                goto Done;
+                return false;
             }
 
-            pbnjson::JValue schedule = pbnjson::Object();
-            schedule.put("expire", expire);
-            postCreateToast.put("schedule", schedule);
+            record.expire = expire;
         }
     }
     else
     {
         time_t currTime = time(NULL);
-        int64_t expire = currTime +
-                         (static_cast<int64_t>(Settings::instance()->getRetentionPeriod()) * 24 * 60 * 60);
-
-        pbnjson::JValue schedule = pbnjson::Object();
-        schedule.put("expire", expire);
-        postCreateToast.put("schedule", schedule);
+        record.expire = currTime +
+                        (static_cast<int64_t>(Settings::instance()->getRetentionPeriod()) * 24 * 60 * 60);
     }
 
-    reqExtra = request["extra"];
-    if (reqExtra.isObject())
+    if (request.extra.set)
     {
-        pbnjson::JValue reqImages = reqExtra["images"];
-        if (reqImages.isArray() && reqImages.arraySize() > 0)
+        const auto& images = request.extra.value.images.value;
+        record.images.reserve(images.size());
+        for (const auto& image : images)
         {
-            pbnjson::JValue images = pbnjson::Array();
-
-            size_t arraySize = reqImages.arraySize();
-            for (size_t i = 0; i < arraySize; ++i)
+            if (image.uri.value.empty())
             {
-                pbnjson::JValue reqImage = reqImages[i];
-                std::string uri = reqImage["uri"].asString();
-
-                if (uri.empty())
-                {
-                    errText = std::string("image should have uri");
-                    goto Done;
-                }
-
-                pbnjson::JValue image = pbnjson::Object();
-                image.put("uri", uri);
-                images.append(image);
+                errText = std::string("image should have uri");
+                return false;
             }
 
-            postCreateToast.put("images", images);
+            record.images.push_back(image.uri.value);
         }
     }
 
-    noaction = request["noaction"].asBool();
-    if (noaction)
+    // Charged only for toasts which would otherwise be posted
+    switch (RateLimiter::instance().admit(caller, toast.sourceId, toast.persistentMsg, batch))
     {
-        postCreateToast.put("action", action);
-        success = NotificationService::instance()->postToastNotification(postCreateToast, staleMsg, persistentMsg, errText);
-        goto Done;
+    case RateLimiter::REJECT:
+        errText = "Rate limit exceeded";
+        return false;
+    case RateLimiter::DOWNGRADE:
+        toast.persistentMsg = false;
+        break;
+    default:
+        break;
     }
 
-    postCreateToast.put("readStatus", false);
-    postCreateToast.put("user", m_user_name);
-    LOG_DEBUG("Toast Payload: %s", JUtil::jsonToString(postCreateToast).c_str());
+    if (!record.collapseKey.empty())
+    {
+        // Take over the toastId of the stored toast this one supersedes, so
+        // history and System UI update it in place
+        std::string previous = History::instance()->findCollapsed(toast.sourceId, record.collapseKey);
+        if (!previous.empty())
+            record.timestamp = previous;
+    }
 
-    appMgrParams = pbnjson::Object();
-    onclick = request["onclick"];
+    // The read and unread counts follow the history, see ToastCounter
+    if (DisplayState* display = DisplayTable::instance().get(displayId))
+        display->toasts++;
 
-    if (onclick.isNull()) // launch the app that creates the toast.
+    toast.toastId = toast.sourceId + "-" + record.timestamp;
+
+    if (!request.noaction.value)
     {
-        postToastCount.put("displayId", displayId);
-        if (displayId >= 0)
+        const auto& onclick = request.onclick.value;
+
+        record.trackRead = true;
+        record.user = m_user_name;
+
+        if (!request.onclick.set) // launch the app that creates the toast.
+        {
+            // Check the SourceId exist in the App list.
+            record.launch = appExist;
+            if (appExist)
+                record.launchId = toast.sourceId;
+        }
+        else if (!onclick.appId.value.empty())
         {
-            postToastCount.put("readCount", toastCountVector[displayId].readCount);
-            postToastCount.put("unreadCount", toastCountVector[displayId].unreadCount);
-            postToastCount.put("totalCount", toastCountVector[displayId].readCount + toastCountVector[displayId].unreadCount);
+            record.launch = true;
+            record.launchId = onclick.appId.value;
+            if (onclick.params.set)
+                record.launchParams = onclick.params.value;
         }
-        toastCountStatus = NotificationService::instance()->postToastCountNotification(std::move(postToastCount), staleMsg, persistentMsg, errText);
-        // Check the SourceId exist in the App list.
-        if (AppList::instance()->isAppExist(sourceId))
+        else if (!onclick.target.value.empty())
         {
-            appMgrParams.put("id", sourceId);
+            record.launch = true;
+            record.launchTarget = onclick.target.value;
         }
         else
         {
-            postCreateToast.put("action", action);
-            success = NotificationService::instance()->postToastNotification(postCreateToast, staleMsg, persistentMsg, errText);
-            goto Done;
+            // Check the SourceId exist in the App list.
+            record.launch = appExist;
+            if (appExist)
+                record.launchId = toast.sourceId;
         }
     }
+
+    record.sourceId = toast.sourceId;
+    record.message = toast.message;
+    toast.valid = true;
+    return true;
+}
+
+void NotificationService::postToastCount(int displayId)
+{
+    if (!DisplayTable::isValid(displayId))
+        return;
+
+    m_countPost.changes++;
+    m_countPost.displays.insert(displayId);
+    if (m_countPost.timer)
+        return;
+
+    guint interval = Settings::instance()->getToastCountInterval();
+    if (!interval)
+    {
+        flushToastCounts();
+        return;
+    }
+    m_countPost.timer = g_timeout_add(interval, NotificationService::cbToastCountTimer, this);
+}
+
+gboolean NotificationService::cbToastCountTimer(gpointer data)
+{
+    NotificationService* service = static_cast<NotificationService*>(data);
+    service->m_countPost.timer = 0;
+    service->flushToastCounts();
+    return G_SOURCE_REMOVE;
+}
+
+void NotificationService::flushToastCounts()
+{
+    static JsonWriter writer;
+
+    for (int displayId : m_countPost.displays)
+    {
+        DisplayState* display = DisplayTable::instance().get(displayId);
+        if (!display)
+            continue;
+
+        // UIs drop posts with a sequence older than the last one they rendered
+        display->countSequence++;
+
+        writer.clear();
+        writer.beginObject().member("displayId", displayId);
+        writer.member("readCount", display->readCount);
+        writer.member("unreadCount", display->unreadCount);
+        writer.member("totalCount", display->totalCount());
+        writer.member("sequence", static_cast<int64_t>(display->countSequence));
+        writer.member("returnValue", true).endObject();
+
+        std::string errorText;
+        if (!postToastCountNotification(displayId, writer.str(), false, false, errorText))
+            LOG_DEBUG("Posting toast count of display %d failed: %s", displayId, errorText.c_str());
+        m_countPost.posts++;
+    }
+    m_countPost.displays.clear();
+}
+
+bool NotificationService::cb_createToast(LSHandle* lshandle, LSMessage *msg, void *user_data)
+{
+    LSErrorSafe lserror;
+
+    bool success = false;
+
+    std::string errText;
+    ToastRequest toast;
+
+    CreateToastRequest request;
+    std::string parseError;
+
+    const CallerProfile& caller = CallerProfiles::instance().lookup(msg);
+    if (caller.callerId.empty())
+    {
+        LOG_WARNING(MSGID_CT_CALLERID_MISSING, 0, "Caller ID is missing in %s", __PRETTY_FUNCTION__);
+        errText = "Unknown Source";
+        goto Done;
+    }
+    LOG_WARNING(MSGID_NOTIFICATIONMGR, 0, "[%s:%d] Caller: %s", __FUNCTION__, __LINE__, caller.callerId.c_str());
+
+    if (!CreateToastRequest::parse(LSMessageGetPayload(msg), request, parseError))
+    {
+        LOG_WARNING(MSGID_CT_PARSE_FAIL, 0, "Message parsing error in %s: %s", __PRETTY_FUNCTION__, parseError.c_str());
+        errText = "Message is not parsed";
+        goto Done;
+    }
+
+    if (!NotificationService::instance()->buildToast(caller, request, toast, errText))
+        goto Done;
+
+    // Post a message
+    success = NotificationService::instance()->postToastNotification(std::move(toast.record), toast.staleMsg, toast.persistentMsg, errText);
+
+Done:
+    static JsonWriter writer;
+    writer.clear();
+    writer.beginObject().member("returnValue", success);
+
+    if (!success)
+    {
+        writer.member("errorText", errText);
+
+        LOG_WARNING(MSGID_NOTIFY_INVOKE_FAILED, 4,
+                    PMLOGKS("SOURCE_ID", toast.sourceId.c_str()),
+                    PMLOGKS("TYPE", "TOAST"),
+                    PMLOGKS("ERROR", errText.c_str()),
+                    PMLOGKS("CONTENT", toast.message.c_str()),
+                    " ");
+    }
     else
     {
-        launchAppId = onclick["appId"].asString();
-        target = onclick["target"].asString();
-        if (launchAppId.length() != 0)
-        { // check for valid App
-            appMgrParams.put("id", launchAppId);
-            if (!onclick["params"].isNull())
-                appMgrParams.put("params", onclick["params"]);
+        writer.member("toastId", toast.toastId);
+
+        LOG_INFO_WITH_CLOCK(MSGID_NOTIFY_INVOKE, 3,
+            PMLOGKS("SOURCE_ID", toast.sourceId.c_str()),
+            PMLOGKS("TYPE", "TOAST"),
+            PMLOGKS("CONTENT", toast.message.c_str()),
+            " ");
+    }
+    writer.endObject();
+
+    if (!LSMessageReply(lshandle, msg, writer.c_str(), &lserror))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+//->Start of API documentation comment block
+/**
+@page com_webos_notification com.webos.notification
+@{
+@section com_webos_notification_createToasts createToasts
+
+Creates several toast notifications in one call. Persistent toasts are saved
+to history with a single db8 put. Each toast is charged to the rate limit of
+its source, and may use the BatchBurst headroom of the source's quota.
+
+@par Parameters
+Name | Required | Type | Description
+-----|----------|------|------------
+toasts | yes  | Array | Array of createToast parameter objects
+
+@par Returns(Call)
+Name | Required | Type | Description
+-----|----------|------|------------
+returnValue | yes | Boolean | True if the batch was parsed
+results | yes | Array | Per-toast results in request order. Each item has returnValue and either toastId or errorText.
+
+@par Returns(Subscription)
+None
+
+@}
+*/
+//->End of API documentation comment block
+
+bool NotificationService::cb_createToasts(LSHandle* lshandle, LSMessage *msg, void *user_data)
+{
+    LSErrorSafe lserror;
+
+    bool success = false;
+
+    std::string errText;
+
+    CreateToastsRequest request;
+    std::string parseError;
+    const std::vector<CreateToastsRequest::ToastsItem>& toastArray = request.toasts.value;
+    JsonWriter results(1024);
+
+    std::vector<ToastRequest> toasts;
+    std::vector<std::string> buildErrors;
+
+    const CallerProfile& caller = CallerProfiles::instance().lookup(msg);
+    if (caller.callerId.empty())
+    {
+        LOG_WARNING(MSGID_CT_CALLERID_MISSING, 0, "Caller ID is missing in %s", __PRETTY_FUNCTION__);
+        errText = "Unknown Source";
+        goto Done;
+    }
+    LOG_WARNING(MSGID_NOTIFICATIONMGR, 0, "[%s:%d] Caller: %s", __FUNCTION__, __LINE__, caller.callerId.c_str());
+
+    if (!CreateToastsRequest::parse(LSMessageGetPayload(msg), request, parseError))
+    {
+        LOG_WARNING(MSGID_CT_PARSE_FAIL, 0, "Message parsing error in %s: %s", __PRETTY_FUNCTION__, parseError.c_str());
+        errText = "Message is not parsed";
+        goto Done;
+    }
+
+    toasts.resize(toastArray.size());
+    results.beginArray();
+    buildErrors.resize(toastArray.size());
+
+    // Build every toast first so that persistent ones are saved before any
+    // toast is posted. The history journal writes them in one batch.
+    for (size_t index = 0; index < toastArray.size(); ++index)
+    {
+        ToastRequest &toast = toasts[index];
+
+        if (!NotificationService::instance()->buildToast(caller, toastArray[index], toast, buildErrors[index], true))
+            continue;
+
+        if (toast.persistentMsg)
+        {
+            pbnjson::JValue json = toast.record.toJson();
+            const std::string& body = toast.record.body(json);
+            History::instance()->saveMessage(std::move(json), body);
         }
-        else if (target.length() != 0)
+    }
+
+    for (size_t index = 0; index < toastArray.size(); ++index)
+    {
+        ToastRequest &toast = toasts[index];
+
+        results.beginObject();
+        if (!toast.valid)
         {
-            appMgrParams.put("target", target);
+            results.member("returnValue", false);
+            results.member("errorText", buildErrors[index]);
+            results.endObject();
+            continue;
+        }
+
+        std::string itemErrText;
+        // Already saved above, so never persist again on delivery.
+        bool posted = NotificationService::instance()->postToastNotification(std::move(toast.record), toast.staleMsg, false, itemErrText);
+
+        results.member("returnValue", posted);
+        if (posted)
+        {
+            results.member("toastId", toast.toastId);
+
+            LOG_INFO_WITH_CLOCK(MSGID_NOTIFY_INVOKE, 3,
+                PMLOGKS("SOURCE_ID", toast.sourceId.c_str()),
+                PMLOGKS("TYPE", "TOAST"),
+                PMLOGKS("CONTENT", toast.message.c_str()),
+                " ");
         }
         else
         {
-            // Check the SourceId exist in the App list.
-            if (AppList::instance()->isAppExist(sourceId))
-            {
-                appMgrParams.put("id", sourceId);
-            }
-            else
-            {
-                postCreateToast.put("action", action);
-                success = NotificationService::instance()->postToastNotification(postCreateToast, staleMsg, persistentMsg, errText);
-                goto Done;
-            }
+            results.member("errorText", itemErrText);
+
+            LOG_WARNING(MSGID_NOTIFY_INVOKE_FAILED, 4,
+                        PMLOGKS("SOURCE_ID", toast.sourceId.c_str()),
+                        PMLOGKS("TYPE", "TOAST"),
+                        PMLOGKS("ERROR", itemErrText.c_str()),
+                        PMLOGKS("CONTENT", toast.message.c_str()),
+                        " ");
         }
+        results.endObject();
     }
-    action.put("serviceURI", APPMGR_LAUNCH_CALL);
-    action.put("serviceMethod", APPMGR_LAUNCH_METHOD);
-    action.put("launchParams", appMgrParams);
-    postCreateToast.put("action", action);
+    results.endArray();
 
-    // Post a message
-    success = NotificationService::instance()->postToastNotification(std::move(postCreateToast), staleMsg, persistentMsg, errText);
+    success = true;
 
-Done:
-    pbnjson::JValue json = pbnjson::Object();
-    json.put("returnValue", success);
+Done:
+    JsonWriter writer(results.str().size() + 64);
+    writer.beginObject().member("returnValue", success);
 
     if (!success)
-    {
-        json.put("errorText", errText);
-
-        LOG_WARNING(MSGID_NOTIFY_INVOKE_FAILED, 4,
-                    PMLOGKS("SOURCE_ID", sourceId.c_str()),
-                    PMLOGKS("TYPE", "TOAST"),
-                    PMLOGKS("ERROR", errText.c_str()),
-                    PMLOGKS("CONTENT", message.c_str()),
-                    " ");
-    }
+        writer.member("errorText", errText);
     else
-    {
-        json.put("toastId", (sourceId + "-" + timestamp));
-
-        LOG_INFO_WITH_CLOCK(MSGID_NOTIFY_INVOKE, 3,
-            PMLOGKS("SOURCE_ID", sourceId.c_str()),
-            PMLOGKS("TYPE", "TOAST"),
-            PMLOGKS("CONTENT", message.c_str()),
-            " ");
-    }
+        writer.key("results").raw(results.str());
+    writer.endObject();
 
-    std::string result = pbnjson::JGenerator::serialize(json, pbnjson::JSchemaFragment("{}"));
-    if (!LSMessageReply(lshandle, msg, result.c_str(), &lserror))
+    if (!LSMessageReply(lshandle, msg, writer.c_str(), &lserror))
     {
         return false;
     }
@@ -784,19 +1020,19 @@ bool NotificationService::alertRespondWithError(LSMessage* message, const std::s
 	return LSMessageRespond(message, result.c_str(), NULL);
 }
 
-bool NotificationService::alertRespond(LSMessage* msg, const std::string& sourceId, const std::string& alertId, const std::string& alertTitle, const std::string& alertMessage, const pbnjson::JValue& postCreateAlert)
+bool NotificationService::alertRespond(LSMessage* msg, const std::string& sourceId, const std::string& alertId, const std::string& alertTitle, const std::string& alertMessage, AlertRecord postCreateAlert)
 {
 	if (!UiStatus::instance().isEnabled(UiStatus::ENABLE_UI))
 	{
 		//save the message in the queue.
 		LOG_DEBUG("createAlert: UI is not yet ready. push into msg queue.");
-		NotificationService::instance()->alertMsgQueue.push(postCreateAlert);
+		NotificationService::instance()->pushAlertMsgQueue(std::move(postCreateAlert));
 	}
 	else
 	{
 		//Post the message
 		std::string errText;
-		if(!NotificationService::instance()->postAlertNotification(postCreateAlert, errText))
+		if(!NotificationService::instance()->postAlertNotification(std::move(postCreateAlert), errText))
 		{
 			return alertRespondWithError(msg, sourceId, alertId, alertTitle, alertMessage, errText);
 		}
@@ -824,7 +1060,7 @@ struct AlertData
 	std::string alertId;
 	std::string alertTitle;
 	std::string alertMessage;
-	pbnjson::JValue postCreateAlert;
+	AlertRecord postCreateAlert;
 	std::vector<std::string> uriList;
 	std::string uriVerified;
 	std::string serviceNameCreateAlert;
@@ -833,7 +1069,7 @@ struct AlertData
 bool NotificationService::alertRespond(bool success, const std::string &errorText,
         LSMessageWrapper msg, const std::string& sourceId,
         const std::string& alertId, const std::string& alertTitle, const std::string& alertMessage,
-        const pbnjson::JValue& postCreateAlert)
+        AlertRecord postCreateAlert)
 {
     std::string errText = errorText;
 
@@ -843,12 +1079,12 @@ bool NotificationService::alertRespond(bool success, const std::string &errorTex
         {
             //save the message in the queue.
             LOG_DEBUG("createAlert: UI is not yet ready. push into msg queue.");
-            NotificationService::instance()->alertMsgQueue.push(postCreateAlert);
+            NotificationService::instance()->pushAlertMsgQueue(std::move(postCreateAlert));
         }
         else
         {
             //Post the message
-            success = NotificationService::instance()->postAlertNotification(postCreateAlert, errText);
+            success = NotificationService::instance()->postAlertNotification(std::move(postCreateAlert), errText);
         }
     }
 
@@ -915,11 +1151,11 @@ bool NotificationService::cb_createAlert(LSHandle* lshandle, LSMessage *msg, voi
 {
 	LSErrorSafe lserror;
 	std::string alertId;
-	pbnjson::JValue request;
-	pbnjson::JValue postCreateAlert;
+	CreateAlertRequest request;
+	std::string parseError;
+	AlertRecord postCreateAlert;
 	pbnjson::JValue alertInfo;
 
-	pbnjson::JValue buttonArray;
 	pbnjson::JValue action;
 	pbnjson::JValue buttonsCreated = pbnjson::Array();
 
@@ -929,79 +1165,70 @@ bool NotificationService::cb_createAlert(LSHandle* lshandle, LSMessage *msg, voi
 	std::string timestamp;
 	std::string iconPath;
 	std::string onclickString;
-	std::string oncloseString;
 	std::string buttonLabel;
-	std::string clickSchemaString;
-
-    std::string alertType;
-    std::string buttonIconPath;
-    std::string buttonType;
-    int checkConfirmType;
-    int checkWarningType;
-    int checkBattertType;
-    int checkOkType;
-    int checkCancelType;
+
     bool ignoreDisable = false;
     int displayId = 0;
+    RateLimiter::Verdict rateVerdict;
 
 	unsigned found = 0;
-	JUtil::Error error;
 
 	std::vector<std::string> uriList;
 
-    std::string caller = LSUtils::getCallerId(msg);
-	if(caller.empty())
+    const CallerProfile& caller = CallerProfiles::instance().lookup(msg);
+	if(caller.callerId.empty())
 	{
 	    LOG_WARNING(MSGID_CALLERID_MISSING, 1, PMLOGKS("API", "createAlert"), " ");
 	    return alertRespond(false, "Unknown Source", msg, sourceId, alertId, "", "");
 	}
 
-	sourceId = std::string(caller);
+	sourceId = caller.callerId;
 
 	//Check for Caller Id
-	if(!Settings::instance()->isPrivilegedSource(caller) && !Settings::instance()->isPartOfAggregators(sourceId))
+	if(!caller.trusted())
 	{
 		LOG_WARNING(MSGID_PERMISSION_DENY, 1,
 			PMLOGKS("API", "createAlert"), " ");
 		return alertRespondWithError(msg, sourceId, alertId, "", "", "Permission Denied");
 	}
 
-	request = JUtil::parse(LSMessageGetPayload(msg), "createAlert", &error);
-
-	if(request.isNull())
+	// Types and the type/buttonType enums are checked against createAlert.schema here
+	if(!CreateAlertRequest::parse(LSMessageGetPayload(msg), request, parseError))
 	{
-		LOG_WARNING(MSGID_CA_PARSE_FAIL, 0, "Message parsing error in %s", __PRETTY_FUNCTION__ );
+		LOG_WARNING(MSGID_CA_PARSE_FAIL, 0, "Message parsing error in %s: %s", __PRETTY_FUNCTION__, parseError.c_str());
 		return alertRespondWithError(msg, sourceId, alertId, "", "", "Message is not parsed");
 	}
 
 	alertInfo = pbnjson::Object();
-	postCreateAlert = pbnjson::Object();
 
 	alertInfo.put("sourceId",sourceId);
 
-	if (request.hasKey("displayId")) {
-	    displayId = request["displayId"].asNumber<int>();
+	if (request.displayId.set) {
+	    displayId = static_cast<int>(request.displayId.value);
 //	    LOG_INFO("port displayId: %d", displayId);
 	    LOG_WARNING(MSGID_NOTIFICATIONMGR, 0, "port [%s:%d] displayId: %d", __FUNCTION__, __LINE__, displayId);
 	}
 	alertInfo.put("displayId", displayId);
 
-	if(!request["title"].isNull())
+	if(request.title.set)
 	{
-		title = request["title"].asString();
-		//Remove if there is any space character except ' '
-		std::replace_if(title.begin(), title.end(), Utils::isEscapeChar, ' ');
+		title = request.title.value;
+		//Replace escape characters, drop control characters and broken UTF-8
+		Utils::sanitizeText(title);
 		alertInfo.put("title", title);
 	}
 
-	message = request["message"].asString();
-	if(message.length() == 0)
+	//Replace escape characters, drop control characters and broken UTF-8
+	//before the check, a message of control characters is blank
+	message = request.message.value;
+	Utils::sanitizeText(message);
+	if(message.find_first_not_of(' ') == std::string::npos)
 	{
 		LOG_WARNING(MSGID_CA_MSG_EMPTY, 0, "Empty message is given in %s", __PRETTY_FUNCTION__);
 		return alertRespondWithError(msg, sourceId, alertId, title, "", "Message can't be empty");
 	}
 
-        ignoreDisable = request["ignoreDisable"].asBool();
+        ignoreDisable = request.ignoreDisable.value;
 
         if (!ignoreDisable && UiStatus::instance().alert() && !(UiStatus::instance().alert())->isEnabled(UiStatus::ENABLE_ALL & ~UiStatus::ENABLE_UI))
         {
@@ -1009,17 +1236,16 @@ bool NotificationService::cb_createAlert(LSHandle* lshandle, LSMessage *msg, voi
         }
 
 	//Copy the message
-	//Remove if there is any space character except ' '
-        std::replace_if(message.begin(), message.end(), Utils::isEscapeChar, ' ');
         alertInfo.put("message", message);
 
 	//Check the icon and copy it.
-	if(!request["iconUrl"].isNull())
+	if(request.iconUrl.set)
 	{
-		iconPath = request["iconUrl"].asString();
-		if(iconPath.length() != 0 && Utils::verifyFileExist(iconPath.c_str()))
+		iconPath = request.iconUrl.value;
+		std::string iconUrl;
+		if(IconCache::instance().resolve(iconPath, &iconUrl))
 		{
-			alertInfo.put("iconUrl", "file://"+iconPath);
+			alertInfo.put("iconUrl", iconUrl);
 		}
 		else
 		{
@@ -1027,177 +1253,118 @@ bool NotificationService::cb_createAlert(LSHandle* lshandle, LSMessage *msg, voi
 		}
 	}
 
-	//Check for modal property. If not defined, add it and set to false.
-	if(request["modal"].isNull())
-	{
-		alertInfo.put("modal", false);
-	}
-	else
-	{
-		alertInfo.put("modal", request["modal"]);
-	}
+	//Check for modal property. If not defined, set it to false.
+	alertInfo.put("modal", request.modal.value);
 
 	//Check for timeout property
-	if(!request["autoTimeout"].isNull())
+	if(request.autoTimeout.set)
 	{
-		int timeout = request["autoTimeout"].asNumber<int>();
+		int timeout = static_cast<int>(request.autoTimeout.value);
 		timeout = (timeout > 15) ? 15 : timeout;
 		alertInfo.put("timeout", timeout);
 	}
 
 	//Check Alert Type
-    if(!request["type"].isNull())
+    if(request.type.set)
     {
-        alertType = request["type"].asString();
-
-        checkConfirmType = alertType.compare("confirm");
-        checkWarningType = alertType.compare("warning");
-        checkBattertType = alertType.compare("battery");
-
-        if(checkConfirmType == 0 || checkWarningType == 0 || checkBattertType == 0)
-        {
-            alertInfo.put("type", alertType);
-        }
-        if(checkConfirmType != 0 && checkWarningType != 0 && checkBattertType != 0)
-        {
-            LOG_WARNING("CA_MSG_TYPE_FAIL", 0, "Message type is wrong %s", __PRETTY_FUNCTION__);
-            return alertRespondWithError(msg, sourceId, alertId, title, message, "Message type is only confirm, warning, or battery");
-        }
+        alertInfo.put("type", request.type.value);
     }
 
-    if(request["isSysReq"].isNull())
-    {
-        alertInfo.put("isSysReq", false);
-    }
-    else
-    {
-        alertInfo.put("isSysReq", request["isSysReq"].asBool());
-    }
-////////// 15.01.05
-    if(request["isNotiSave"].isNull())
-    {
-        alertInfo.put("isNotiSave", false);
-    }
-    else
-    {
-        alertInfo.put("isNotiSave", request["isNotiSave"].asBool());
-    }
+    alertInfo.put("isSysReq", request.isSysReq.value);
+
+	alertInfo.put("onCloseAction", JsonParser::createActionInfo(request.onclose.value.uri.value, request.onclose.value.params.value));
+	alertInfo.put("onFailAction", JsonParser::createActionInfo(request.onfail.value.uri.value, request.onfail.value.params.value));
 
 	//Check for onclose event object
-	if(!request["onclose"].isNull())
+	if(!request.onclose.value.uri.value.empty())
 	{
-        pbnjson::JValue oncloseObj = request["onclose"];
-		oncloseString = oncloseObj["uri"].asString();
+		uriList.push_back(request.onclose.value.uri.value);
 	}
 
-	alertInfo.put("onCloseAction", JsonParser::createActionInfo(request["onclose"]));
-	alertInfo.put("onFailAction", JsonParser::createActionInfo(request["onfail"]));
-
-	if(!oncloseString.empty())
+	if(request.buttons.value.empty())
 	{
-		uriList.push_back(oncloseString);
+		LOG_WARNING(MSGID_CA_BUTTONS_EMPTY, 0, "No buttons are given in %s", __PRETTY_FUNCTION__);
+		return alertRespondWithError(msg, sourceId, alertId, title, message, "Buttons can't be empty!");
 	}
 
-	if(!request["buttons"].isNull())
-    {
-		buttonArray = request["buttons"];
+	for(const auto& button : request.buttons.value) {
+		pbnjson::JValue buttonObj = pbnjson::Object();
 
-		if(buttonArray.isArray())
-		{
-			if(buttonArray.arraySize() == 0)
-			{
-				LOG_WARNING(MSGID_CA_BUTTONS_EMPTY, 0, "No buttons are given in %s", __PRETTY_FUNCTION__);
-				return alertRespondWithError(msg, sourceId, alertId, title, message, "Buttons can't be empty!");
-			}
+		//Copy label
+		buttonLabel = button.label.value;
+		Utils::sanitizeText(buttonLabel);
 
-			for(ssize_t index = 0; index < buttonArray.arraySize(); ++index) {
-				pbnjson::JValue buttonObj = pbnjson::Object();
+		buttonObj.put("label", buttonLabel);
 
-				//Copy label
-                buttonLabel = buttonArray[index]["label"].asString();
-                std::replace_if(buttonLabel.begin(), buttonLabel.end(), Utils::isEscapeChar, ' ');
+		//Check for buttonType
+		if(button.buttonType.set)
+		{
+			buttonObj.put("type", button.buttonType.value);
+		}
 
-				buttonObj.put("label", buttonLabel);
+		//Check for onclick
+		if(button.onclick.set || button.onClick.set)
+		{
+			onclickString = button.onclick.set ? button.onclick.value : button.onClick.value;
 
-				 //Check for buttonType
-                if(!buttonArray[index]["buttonType"].isNull())
-                {
-                    buttonType = buttonArray[index]["buttonType"].asString();
+			action = pbnjson::Object();
+			if(!Utils::isValidURI(onclickString))
+			{
+				LOG_WARNING(MSGID_CA_SERVICEURI_INVALID, 0, "Invalid ServiceURI is given in %s", __PRETTY_FUNCTION__);
+				return alertRespondWithError(msg, sourceId, alertId, title, message, "Invalid Service Uri in the onclick");
+			}
 
-                    checkOkType = buttonType.compare("ok");
-                    checkCancelType = buttonType.compare("cancel");
+			found = onclickString.find_last_of("/");
 
-                    if(checkOkType == 0 || checkCancelType == 0)
-                    {
-                        buttonObj.put("type", buttonType);
-                    }
-                    if(checkOkType != 0 && checkCancelType != 0)
-                    {
-                        LOG_WARNING("CA_MSG_TYPE_FAIL", 0, "Button type is wrong %s", __PRETTY_FUNCTION__);
-                        return alertRespondWithError(msg, sourceId, alertId, title, message, "Button type is only ok or cancel");
-                    }
-                }
+			action.put("serviceURI", onclickString.substr(0, found+1));
+			action.put("serviceMethod", onclickString.substr(found+1));
+
+			if(button.params.set)
+			{
+				action.put("launchParams", button.params.value);
+			}
+			else
+			{
+				action.put("launchParams", {});
+			}
 
-				//Check for onclick
-				if(!buttonArray[index]["onclick"].isNull() || !buttonArray[index]["onClick"].isNull())
-				{
-					if(!buttonArray[index]["onclick"].isNull()) {
-						clickSchemaString = "onclick";
-					}
-					else if(!buttonArray[index]["onClick"].isNull()) {
-						clickSchemaString = "onClick";
-					}
-					action = pbnjson::Object();
-					if(!Utils::isValidURI(buttonArray[index][clickSchemaString].asString()))
-					{
-						LOG_WARNING(MSGID_CA_SERVICEURI_INVALID, 0, "Invalid ServiceURI is given in %s", __PRETTY_FUNCTION__);
-						return alertRespondWithError(msg, sourceId, alertId, title, message, "Invalid Service Uri in the onclick");
-					}
-
-					onclickString = buttonArray[index][clickSchemaString].asString();
-					found = onclickString.find_last_of("/");
-
-					action.put("serviceURI", onclickString.substr(0, found+1));
-					action.put("serviceMethod", onclickString.substr(found+1));
-
-					if(!buttonArray[index]["params"].isNull())
-					{
-						action.put("launchParams", buttonArray[index]["params"]);
-					}
-					else
-					{
-						action.put("launchParams", {});
-					}
-
-					buttonObj.put("action", action);
-					if(!onclickString.empty())
-					{
-						uriList.push_back(onclickString);
-					}
-				}
-
-				// Copy focus
-				buttonObj.put("focus", buttonArray[index]["focus"].asBool());
-
-				buttonsCreated.put(index, buttonObj);
+			buttonObj.put("action", action);
+			if(!onclickString.empty())
+			{
+				uriList.push_back(onclickString);
 			}
 		}
-		alertInfo.put("buttons", buttonsCreated);
+
+		// Copy focus
+		buttonObj.put("focus", button.focus.value);
+
+		buttonsCreated.append(buttonObj);
 	}
+	alertInfo.put("buttons", buttonsCreated);
 
-	postCreateAlert.put("alertAction", "open");
-	postCreateAlert.put("alertInfo", alertInfo);
+	// Charged only for alerts which passed validation, like buildToast does
+	rateVerdict = RateLimiter::instance().admit(caller, sourceId, request.isNotiSave.value);
+	if(rateVerdict == RateLimiter::REJECT)
+	{
+		return alertRespondWithError(msg, sourceId, alertId, title, message, "Rate limit exceeded");
+	}
+////////// 15.01.05
+	alertInfo.put("isNotiSave", request.isNotiSave.value && rateVerdict != RateLimiter::DOWNGRADE);
 
 	Utils::createTimestamp(timestamp);
-	postCreateAlert.put("timestamp", timestamp);
 
 	alertId = sourceId + "-" + timestamp;
 	alertInfo.put("alertId", alertId);
 
+	postCreateAlert.action = "open";
+	postCreateAlert.sourceId = sourceId;
+	postCreateAlert.isSysReq = alertInfo["isSysReq"].asBool();
+	postCreateAlert.timestamp = timestamp;
+	postCreateAlert.alertInfo = alertInfo;
 
 	if(uriList.empty())
 	{
-		return alertRespond(msg, sourceId, alertId, title, message, postCreateAlert);
+		return alertRespond(msg, sourceId, alertId, title, message, std::move(postCreateAlert));
 	}
 
 	LSMessageRef(msg);
@@ -1238,7 +1405,6 @@ bool NotificationService::cb_createAlertIsAllowed(LSHandle* lshandle, LSMessage
         std::string alertId = data->alertId;
         std::string alertTitle = data->alertTitle;
         std::string alertMessage = data->alertMessage;
-        pbnjson::JValue postCreateAlert = data->postCreateAlert;
         std::string uriVerified = data->uriVerified;
 
         if(request.isNull())
@@ -1264,8 +1430,9 @@ bool NotificationService::cb_createAlertIsAllowed(LSHandle* lshandle, LSMessage
 
         if(data->uriList.empty())
         {
+                AlertRecord postCreateAlert = std::move(data->postCreateAlert);
                 delete data;
-                return alertRespond(message, sourceId, alertId, alertTitle, alertMessage, postCreateAlert);
+                return alertRespond(message, sourceId, alertId, alertTitle, alertMessage, std::move(postCreateAlert));
         }
 
         std::string uri = data->uriList.back();
@@ -1283,7 +1450,7 @@ bool NotificationService::cb_createAlertIsAllowed(LSHandle* lshandle, LSMessage
         return true;
 }
 
-bool NotificationService::postToastNotification(pbnjson::JValue toastNotificationPayload, bool staleMsg, bool persistentMsg, std::string &errorText)
+bool NotificationService::postToastNotification(ToastRecord toast, bool staleMsg, bool persistentMsg, std::string &errorText)
 {
     LSErrorSafe lserror;
     std::string toastPayload;
@@ -1291,7 +1458,9 @@ bool NotificationService::postToastNotification(pbnjson::JValue toastNotificatio
     //Save the message
     if (persistentMsg)
     {
-        History::instance()->saveMessage(toastNotificationPayload);
+        pbnjson::JValue json = toast.toJson();
+        const std::string& body = toast.body(json);
+        History::instance()->saveMessage(std::move(json), body);
     }
 
     if (staleMsg || (UiStatus::instance().toast() && (UiStatus::instance().toast())->isSilence()))
@@ -1317,15 +1486,26 @@ bool NotificationService::postToastNotification(pbnjson::JValue toastNotificatio
     if(!UI_ENABLED)
     {
         //save the message in the queue.
-        toastMsgQueue.push(toastNotificationPayload);
+        pushToastMsgQueue(std::move(toast));
         return false;
     }
 
-    //Add returnValue to true
-    toastNotificationPayload.put("returnValue", true);
-    toastPayload = pbnjson::JGenerator::serialize(toastNotificationPayload, pbnjson::JSchemaFragment("{}"));
+    if (m_flush.toasts && !m_flush.posting)
+    {
+        // Older toasts are still being flushed, queue behind them to keep the order
+        if (!pushToastMsgQueue(std::move(toast)))
+        {
+            errorText = "Pending toast queue is full";
+            return false;
+        }
+        m_flush.toasts++;
+        return true;
+    }
+
+    //Add returnValue to true, reusing the body already generated for the history
+    toastPayload = JUtil::prependMembers(toast.body(), "\"returnValue\":true");
 
-    if(!LSSubscriptionPost(getHandle(), get_category(), "getToastNotification", toastPayload.c_str(), &lserror) && lserror.message)
+    if(!postDisplay("getToastNotification", toast.displayId, toastPayload.c_str(), &lserror) && lserror.message)
     {
         errorText = lserror.message;
         return false;
@@ -1334,16 +1514,11 @@ bool NotificationService::postToastNotification(pbnjson::JValue toastNotificatio
     return true;
 }
 
-bool NotificationService::postToastCountNotification(pbnjson::JValue toastCountPayload, bool staleMsg, bool persistentMsg, std::string &errorText)
+bool NotificationService::postToastCountNotification(int displayId, const std::string& countPayload, bool staleMsg, bool persistentMsg, std::string &errorText)
 {
     LSErrorSafe lserror;
-    std::string countPayload;
 
-    //Add returnValue to true
-    toastCountPayload.put("returnValue", true);
-    countPayload = pbnjson::JGenerator::serialize(toastCountPayload, pbnjson::JSchemaFragment("{}"));
-
-    if(!LSSubscriptionPost(getHandle(), get_category(), "getToastCount", countPayload.c_str(), &lserror) && lserror.message)
+    if(!postDisplay("getToastCount", displayId, countPayload.c_str(), &lserror) && lserror.message)
     {
         errorText = lserror.message;
         return false;
@@ -1352,10 +1527,43 @@ bool NotificationService::postToastCountNotification(pbnjson::JValue toastCountP
     return true;
 }
 
-bool NotificationService::postAlertNotification(pbnjson::JValue alertNotificationPayload, std::string &errorText)
+std::string NotificationService::subscriptionKey(const char* method, int displayId)
+{
+    // The broadcast key is the one LSSubscriptionProcess() and LSSubscriptionPost() use
+    std::string key = std::string("/") + method;
+    if (displayId >= 0)
+        key += "/" + Utils::toString(displayId);
+    return key;
+}
+
+bool NotificationService::subscribeDisplay(LSHandle* lshandle, LSMessage* msg, const char* method, int displayId, LSError* lserror)
+{
+    if (!DisplayTable::isValid(displayId))
+        displayId = -1;
+    return LSSubscriptionAdd(lshandle, subscriptionKey(method, displayId).c_str(), msg, lserror);
+}
+
+unsigned int NotificationService::subscriberCount(LSHandle* lshandle, const char* method)
+{
+    unsigned int count = LSSubscriptionGetHandleSubscribersCount(lshandle, subscriptionKey(method, -1).c_str());
+    int displays = static_cast<int>(Settings::instance()->getMaxDisplays());
+    for (int displayId = 0; displayId < displays; ++displayId)
+        count += LSSubscriptionGetHandleSubscribersCount(lshandle, subscriptionKey(method, displayId).c_str());
+    return count;
+}
+
+bool NotificationService::postDisplay(const char* method, int displayId, const char* payload, LSError* lserror)
+{
+    if (displayId >= 0 && !LSSubscriptionReply(getHandle(), subscriptionKey(method, displayId).c_str(), payload, lserror))
+        return false;
+    return LSSubscriptionReply(getHandle(), subscriptionKey(method, -1).c_str(), payload, lserror);
+}
+
+bool NotificationService::postAlertNotification(AlertRecord alert, std::string &errorText)
 {
 	LSErrorSafe lserror;
 	std::string alertPayload;
+	pbnjson::JValue alertNotificationPayload;
 
 	//In Factory Mode, disable alert notifications
     if(BLOCK_ALERT_NOTIFICATION) {
@@ -1366,11 +1574,24 @@ bool NotificationService::postAlertNotification(pbnjson::JValue alertNotificatio
     if(!UI_ENABLED)
     {
         //save the message in the queue.
-        alertMsgQueue.push(alertNotificationPayload);
+        pushAlertMsgQueue(std::move(alert));
         return false;
     }
 
+    if (m_flush.alerts && !m_flush.posting)
+    {
+        // Older alerts are still being flushed, queue behind them to keep the order
+        if (!pushAlertMsgQueue(std::move(alert)))
+        {
+            errorText = "Pending alert queue is full";
+            return false;
+        }
+        m_flush.alerts++;
+        return true;
+    }
+
 	//Add returnValue to true
+	alertNotificationPayload = alert.toJson();
 	alertNotificationPayload.put("returnValue", true);
 
 	alertPayload = pbnjson::JGenerator::serialize(alertNotificationPayload, pbnjson::JSchemaFragment("{}"));
@@ -1416,25 +1637,21 @@ bool NotificationService::cb_closeToast(LSHandle* lshandle, LSMessage *msg, void
 
     bool success = false;
 
-    std::string toastId;
-    std::string sourceId;
     std::string errText;
     std::string timestamp;
 
-    pbnjson::JValue request;
-    JUtil::Error error;
+    CloseToastRequest request;
+    std::string parseError;
+    const std::string& toastId = request.toastId.value;
+    const std::string& sourceId = request.sourceId.value;
 
-    request = JUtil::parse(LSMessageGetPayload(msg), "closeToast", &error);
-
-    if(request.isNull())
+    if(!CloseToastRequest::parse(LSMessageGetPayload(msg), request, parseError))
     {
-        LOG_WARNING(MSGID_CLT_PARSE_FAIL, 0, "Parsing Error in %s", __PRETTY_FUNCTION__ );
+        LOG_WARNING(MSGID_CLT_PARSE_FAIL, 0, "Parsing Error in %s: %s", __PRETTY_FUNCTION__, parseError.c_str());
         errText = "Message is not parsed";
         goto Done;
     }
 
-    toastId = request["toastId"].asString();
-    sourceId = request["sourceId"].asString();
     if(toastId.empty() && sourceId.empty())
     {
         LOG_WARNING(MSGID_CLT_TOASTID_MISSING, 0, "Both Toast ID and Source ID are missing in %s", __PRETTY_FUNCTION__);
@@ -1469,11 +1686,7 @@ bool NotificationService::cb_closeToast(LSHandle* lshandle, LSMessage *msg, void
             }
         }
 
-        bool privilegedSource = false;
-        if (Settings::instance()->isPrivilegedSource(caller) || Settings::instance()->isPartOfAggregators(std::string(caller)))
-            privilegedSource = true;
-
-        if (!privilegedSource)
+        if (!CallerProfiles::instance().lookup(caller).trusted())
         {
             LOG_WARNING(MSGID_PERMISSION_DENY, 1,
                 PMLOGKS("API", "closeToast"), " ");
@@ -1541,7 +1754,7 @@ bool NotificationService::cb_closeAlert(LSHandle* lshandle, LSMessage *msg, void
 	std::string sourceId;
 
 	pbnjson::JValue request;
-	pbnjson::JValue postAlertMessage;
+	AlertRecord postAlertMessage;
 	pbnjson::JValue alertInfo;
 
 	JUtil::Error error;
@@ -1571,15 +1784,14 @@ bool NotificationService::cb_closeAlert(LSHandle* lshandle, LSMessage *msg, void
 		goto Done;
 	}
 
-	postAlertMessage = pbnjson::Object();
 	alertInfo = pbnjson::Object();
 
 	alertInfo.put("timestamp", timestamp);
-	postAlertMessage.put("alertAction", "close");
-	postAlertMessage.put("alertInfo", alertInfo);
+	postAlertMessage.action = "close";
+	postAlertMessage.alertInfo = alertInfo;
 
 	//Post the message
-	success = NotificationService::instance()->postAlertNotification(postAlertMessage, errText);
+	success = NotificationService::instance()->postAlertNotification(std::move(postAlertMessage), errText);
 
 Done:
 	pbnjson::JValue json = pbnjson::Object();
@@ -1629,7 +1841,7 @@ bool NotificationService::cb_closeAllAlerts(LSHandle* lshandle, LSMessage *msg,
 	std::string errText;
 
 	pbnjson::JValue request;
-	pbnjson::JValue postAlertMessage;
+	AlertRecord postAlertMessage;
 
 	JUtil::Error error;
 
@@ -1664,11 +1876,10 @@ bool NotificationService::cb_closeAllAlerts(LSHandle* lshandle, LSMessage *msg,
 		goto Done;
 	}
 
-	postAlertMessage = pbnjson::Object();
-	postAlertMessage.put("alertAction", "closeAll");
+	postAlertMessage.action = "closeAll";
 
 	//Post the message
-	success = NotificationService::instance()->postAlertNotification(postAlertMessage, errText);
+	success = NotificationService::instance()->postAlertNotification(std::move(postAlertMessage), errText);
 
 Done:
 	pbnjson::JValue json = pbnjson::Object();
@@ -1714,6 +1925,14 @@ void NotificationService::postNotification(pbnjson::JValue notificationPayload,
         pushNotiMsgQueue(notificationPayload, remove, removeAll);
         return;
     }
+
+    if (m_flush.notifications && !m_flush.posting)
+    {
+        // Older notifications are still being flushed, queue behind them to keep the order
+        if (pushNotiMsgQueue(notificationPayload, remove, removeAll))
+            m_flush.notifications++;
+        return;
+    }
     //Save the message
     if(!remove && !removeAll)
     {
@@ -1860,7 +2079,6 @@ bool NotificationService::cb_removeAllNotification(LSHandle* lshandle, LSMessage
     bool success = false;
 
     std::string errText;
-    std::string checkCaller;
 
     pbnjson::JValue postRemoveAllNotiMessage = pbnjson::Object();
 
@@ -1874,18 +2092,17 @@ bool NotificationService::cb_removeAllNotification(LSHandle* lshandle, LSMessage
     std::string displayCategory;
     pbnjson::JValue countKeyObj = pbnjson::Object();
 
-    std::string caller = LSUtils::getCallerId(msg);
-    if(caller.empty())
+    const CallerProfile& caller = CallerProfiles::instance().lookup(msg);
+    if(caller.callerId.empty())
     {
         errText = "Unknown Source";
         goto Done;
     }
-    LOG_WARNING(MSGID_NOTIFICATIONMGR, 0, "[%s:%d] Caller: %s", __FUNCTION__, __LINE__, caller.c_str());
+    LOG_WARNING(MSGID_NOTIFICATIONMGR, 0, "[%s:%d] Caller: %s", __FUNCTION__, __LINE__, caller.callerId.c_str());
 
     // Check for Caller Id
-    checkCaller = Utils::extractSourceIdFromCaller(caller);
-    LOG_DEBUG("cb_removeAllNotification Caller = %s, %zu", checkCaller.c_str(), std::string(checkCaller).find(PRIVILEGED_SYSTEM_UI_SOURCE));
-    if (std::string(checkCaller).find(PRIVILEGED_SYSTEM_UI_SOURCE) == std::string::npos)
+    LOG_DEBUG("cb_removeAllNotification Caller = %s", caller.sourceId.c_str());
+    if (!caller.surfaceManager)
     {
         LOG_WARNING(MSGID_CA_PERMISSION_DENY, 0, "Caller is neither privileged source nor part of aggregators in %s", __PRETTY_FUNCTION__);
         success = false;
@@ -1901,16 +2118,18 @@ bool NotificationService::cb_removeAllNotification(LSHandle* lshandle, LSMessage
     }
     LOG_DEBUG("Remove Payload: %s", JUtil::jsonToString(std::move(request)).c_str());
 
+    if (displayId >= 0 && !DisplayTable::isValid(displayId))
+    {
+        errText = DisplayTable::invalidText();
+        goto Done;
+    }
+
     postRemoveAllNotiMessage.put("removeAllNotiId", true);
     postRemoveAllNotiMessage.put("displayId", displayId);
 
     //Post the message
     NotificationService::instance()->postNotification(postRemoveAllNotiMessage, false, true);
     success = true;
-    if (displayId >= 0) {
-        toastCountVector[displayId].readCount = 0;
-        toastCountVector[displayId].unreadCount = 0;
-    }
 
 Done:
     pbnjson::JValue json = pbnjson::Object();
@@ -1932,6 +2151,35 @@ Done:
     return true;
 }
 
+//->Start of API documentation comment block
+/**
+@page com_webos_notification com.webos.notification
+@{
+@section com_webos_notification_getToastList getToastList
+
+Returns the toasts stored in the history of a display
+
+@par Parameters
+Name | Required | Type | Description
+-----|----------|------|------------
+displayId | Yes | Number | Display whose toasts are returned
+readStatus | No | Boolean | Return only read or only unread toasts
+limit | No | Integer | Maximum number of toasts to return, 1 to 500
+page | No | String | The next value of a previous reply to continue from
+
+@par Returns(Call)
+Name | Required | Type | Description
+-----|----------|------|------------
+returnValue | yes | Boolean | True
+toastInfo | yes | Array | Toasts of the display
+next | No | String | Pass as page to get the following toasts. Missing on the last page.
+
+@par Returns(Subscription)
+None
+
+@}
+*/
+//->End of API documentation comment block
 bool NotificationService::cb_getToastList(LSHandle* lshandle, LSMessage *msg, void *user_data)
 {
     LSErrorSafe lserror;
@@ -1952,15 +2200,13 @@ bool NotificationService::cb_getToastList(LSHandle* lshandle, LSMessage *msg, vo
 
     JUtil::Error error;
 
-    History* getReq = NULL;
-
-    std::string caller = LSUtils::getCallerId(msg);
-    if(caller.empty())
+    const CallerProfile& caller = CallerProfiles::instance().lookup(msg);
+    if(caller.callerId.empty())
     {
         errText = "Unknown Source";
         goto Done;
     }
-    LOG_WARNING(MSGID_NOTIFICATIONMGR, 0, "[%s:%d] Caller: %s", __FUNCTION__, __LINE__, caller.c_str());
+    LOG_WARNING(MSGID_NOTIFICATIONMGR, 0, "[%s:%d] Caller: %s", __FUNCTION__, __LINE__, caller.callerId.c_str());
 
     request = JUtil::parse(LSMessageGetPayload(msg), "getToastList", &error);
 
@@ -1973,12 +2219,10 @@ bool NotificationService::cb_getToastList(LSHandle* lshandle, LSMessage *msg, vo
 
     postToastInfoMessage = pbnjson::Object();
 
-    getReq = new History();
-
     displayId = request["displayId"].asNumber<int>();
     postToastInfoMessage.put("displayId", displayId);
 
-    if(Settings::instance()->isPrivilegedSource(caller))
+    if(caller.privileged)
     {
         privilegedSource = true;
     }
@@ -1992,13 +2236,10 @@ bool NotificationService::cb_getToastList(LSHandle* lshandle, LSMessage *msg, vo
 
     postToastInfoMessage.put("sourceId", sourceId);
 
-    if(getReq)
+    success = History::instance()->selectToastMessage(lshandle, sourceId, msg);
+    if (!success)
     {
-        success = getReq->selectToastMessage(lshandle, sourceId, msg);
-        if (!success)
-        {
-            errText = "can't get the notification info from db";
-        }
+        errText = "can't get the notification info from db";
     }
 Done:
     pbnjson::JValue json = pbnjson::Object();
@@ -2060,7 +2301,7 @@ bool NotificationService::cb_enable(LSHandle* lshandle, LSMessage *msg, void *us
         }
     }
 
-    if(!Settings::instance()->isPrivilegedSource(caller) && !Settings::instance()->isPartOfAggregators(std::string(caller)))
+    if(!CallerProfiles::instance().lookup(caller).trusted())
     {
         LOG_WARNING(MSGID_PERMISSION_DENY, 1,
             PMLOGKS("API", "enable"), " ");
@@ -2130,7 +2371,7 @@ bool NotificationService::cb_disable(LSHandle* lshandle, LSMessage *msg, void *u
         }
     }
 
-    if(!Settings::instance()->isPrivilegedSource(caller) && !Settings::instance()->isPartOfAggregators(std::string(caller)))
+    if(!CallerProfiles::instance().lookup(caller).trusted())
     {
         LOG_WARNING(MSGID_PERMISSION_DENY, 1,
             PMLOGKS("API", "disable"), " ");
@@ -2159,39 +2400,129 @@ Done:
     return true;
 }
 
+// Only the messages queued when the flush is requested are posted, the post
+// functions queue their message again while the UI is not ready.
 void NotificationService::processAlertMsgQueue()
 {
-    while(!alertMsgQueue.empty())
-    {
-        std::string errText;
-        NotificationService::instance()->postAlertNotification(alertMsgQueue.front(), errText);
-        alertMsgQueue.pop();
-    }
+    m_flush.alerts = alertMsgQueue.size();
+    schedulePendingFlush();
 }
 
 void NotificationService::processNotiMsgQueue()
 {
-    LOG_WARNING("notificationmgr", 0, "[%s:%d] %s", __FUNCTION__, __LINE__, notiMsgQueue.empty()? "yes" : "no");
-    while(!notiMsgQueue.empty())
-    {
-        NotificationService::instance()->postNotification(notiMsgQueue.front()->getPayLoad(),notiMsgQueue.front()->getRemove(),notiMsgQueue.front()->getRemoveAll());
-        pbnjson::JValue notificationPayload = notiMsgQueue.front()->getPayLoad();
-        LOG_WARNING("notificationmgr", 0, "[%s:%d] notiMsgQueue = %s", __FUNCTION__, __LINE__, JUtil::jsonToString(std::move(notificationPayload)).c_str());
-        popNotiMsgQueue();
-    }
+    LOG_DEBUG("processNotiMsgQueue notiMsgQueue.size() = %zu", notiMsgQueue.size());
+    m_flush.notifications = notiMsgQueue.size();
+    schedulePendingFlush();
 }
 
 void NotificationService::processToastMsgQueue()
 {
-	std::string errText;
-    LOG_DEBUG("processToastMsgQueue processToastMsgQueue.empty() = %s", toastMsgQueue.empty()? "yes" : "no");
-    while(!toastMsgQueue.empty())
+    LOG_DEBUG("processToastMsgQueue toastMsgQueue.size() = %zu", toastMsgQueue.size());
+    m_flush.toasts = toastMsgQueue.size();
+    schedulePendingFlush();
+}
+
+void NotificationService::schedulePendingFlush()
+{
+    if (m_flush.source || !(m_flush.alerts || m_flush.notifications || m_flush.toasts))
+        return;
+
+    m_flush.started = g_get_monotonic_time();
+    m_flush.lastIteration = m_flush.started;
+    m_flush.maxLatency = 0;
+    // Idle priority, so pending LS2 requests are dispatched between batches
+    m_flush.source = g_idle_add_full(G_PRIORITY_DEFAULT_IDLE, NotificationService::cbPendingFlush, this, NULL);
+}
+
+gboolean NotificationService::cbPendingFlush(gpointer data)
+{
+    NotificationService* service = static_cast<NotificationService*>(data);
+    PendingFlush& flush = service->m_flush;
+
+    gint64 now = g_get_monotonic_time();
+    flush.maxLatency = std::max(flush.maxLatency, now - flush.lastIteration);
+
+    gint64 deadline = now + PENDING_FLUSH_BUDGET_US;
+    flush.posting = true;
+    for (int i = 0; i < PENDING_FLUSH_BATCH && now < deadline; ++i)
+    {
+        // Items may have been dropped by the queue limits meanwhile
+        if (flush.notifications && service->notiMsgQueue.empty())
+            flush.notifications = 0;
+        if (flush.alerts && service->alertMsgQueue.empty())
+            flush.alerts = 0;
+        if (flush.toasts && service->toastMsgQueue.empty())
+            flush.toasts = 0;
+
+        std::string errText;
+        if (flush.notifications)
+        {
+            flush.notifications--;
+            NotiMsgItem item = service->notiMsgQueue.pop();
+            service->postNotification(std::move(item.payload), item.remove, item.removeAll);
+        }
+        else if (flush.alerts)
+        {
+            flush.alerts--;
+            service->postAlertNotification(service->alertMsgQueue.pop(), errText);
+        }
+        else if (flush.toasts)
+        {
+            flush.toasts--;
+            ToastRecord toast = service->toastMsgQueue.pop();
+            // Its history row is purged by the expiry timer, don't show it late
+            if (toast.expire && toast.expire < time(NULL) && SystemTime::instance().isSynced())
+                flush.expired++;
+            else
+                service->postToastNotification(std::move(toast), false, false, errText);
+        }
+        else
+        {
+            break;
+        }
+
+        flush.items++;
+        now = g_get_monotonic_time();
+    }
+    flush.posting = false;
+
+    if (flush.notifications || flush.alerts || flush.toasts)
     {
-        NotificationService::instance()->postToastNotification(toastMsgQueue.front(), false, false, errText);
-        pbnjson::JValue toastPayload = toastMsgQueue.front();
-        LOG_DEBUG("processToastMsgQueue toastMsgQueue = %s", JUtil::jsonToString( std::move(toastPayload)).c_str());
-        toastMsgQueue.pop();
+        flush.lastIteration = g_get_monotonic_time();
+        return G_SOURCE_CONTINUE;
     }
+
+    flush.flushes++;
+    flush.lastDuration = g_get_monotonic_time() - flush.started;
+    flush.maxDuration = std::max(flush.maxDuration, flush.lastDuration);
+    flush.lastMaxLatency = flush.maxLatency;
+    flush.source = 0;
+    return G_SOURCE_REMOVE;
+}
+
+pbnjson::JValue NotificationService::pendingStats() const
+{
+    pbnjson::JValue queues = pbnjson::Object();
+    queues.put("alert", pbnjson::JObject{{"items", static_cast<int64_t>(alertMsgQueue.size())},
+                                         {"overflows", static_cast<int64_t>(alertMsgQueue.overflows())}});
+    queues.put("notification", pbnjson::JObject{{"items", static_cast<int64_t>(notiMsgQueue.size())},
+                                                {"overflows", static_cast<int64_t>(notiMsgQueue.overflows())}});
+    queues.put("toast", pbnjson::JObject{{"items", static_cast<int64_t>(toastMsgQueue.size())},
+                                         {"overflows", static_cast<int64_t>(toastMsgQueue.overflows())},
+                                         {"collapsed", static_cast<int64_t>(toastMsgQueue.collapsed())}});
+
+    pbnjson::JValue json = pbnjson::Object();
+    json.put("queues", queues);
+    json.put("flushing", m_flush.source != 0);
+    json.put("flushes", static_cast<int64_t>(m_flush.flushes));
+    json.put("flushedItems", static_cast<int64_t>(m_flush.items));
+    json.put("expiredToasts", static_cast<int64_t>(m_flush.expired));
+    json.put("lastFlushMs", m_flush.lastDuration / 1000.0);
+    json.put("maxFlushMs", m_flush.maxDuration / 1000.0);
+    json.put("lastFlushMaxLoopLatencyMs", m_flush.lastMaxLatency / 1000.0);
+    json.put("toastCountChanges", static_cast<int64_t>(m_countPost.changes));
+    json.put("toastCountPosts", static_cast<int64_t>(m_countPost.posts));
+    return json;
 }
 
 void NotificationService::onAlertStatus(bool enabled)
@@ -2208,12 +2539,6 @@ void NotificationService::setUIEnabled(bool enabled)
     UI_ENABLED = enabled;
 }
 
-NotificationService::NotiMsgItem::NotiMsgItem(pbnjson::JValue payload, bool remove, bool removeAll) {
-    this->payload = payload;
-    this->remove = remove;
-    this->removeAll = removeAll;
-};
-
 //Parsing XML
 bool NotificationService::parseDoc(const char *docname)
 {
@@ -2288,91 +2613,119 @@ bool NotificationService::cb_setToastStatus(LSHandle *lshandle, LSMessage *msg,
 {
     bool success = false;
 
-    pbnjson::JValue json = pbnjson::Object();
-    std::string errText = "";
+    SetToastStatusRequest request;
+    std::string errText;
     LSErrorSafe lserror;
 
-    json = JUtil::parse(LSMessageGetPayload(msg), "", nullptr);
-
-    std::string toastId = json["toastId"].asString();
-    bool status = json["readStatus"].asBool();
-    int displayId = json["displayId"].asNumber<int>();
+    const std::string& toastId = request.toastId.value;
+    bool status = false;
+    int displayId = 0;
 
-    if (!json.hasKey("toastId"))
+    if (!SetToastStatusRequest::parse(LSMessageGetPayload(msg), request, errText))
     {
-        LOG_DEBUG("Missing toastId parameter");
-        json.put("errorText", "Missing toastId parameter");
-        json.put("returnValue", false);
+        LOG_DEBUG("setToastStatus: %s", errText.c_str());
         goto Done;
     }
-    else if(json.hasKey("toastId") && !json["toastId"].isString())
+
+    status = request.readStatus.value;
+    displayId = static_cast<int>(request.displayId.value);
+
+    if (displayId >= 0 && !DisplayTable::isValid(displayId))
     {
-        LOG_DEBUG("toastId should be a string");
-        json.put("errorText", "toastId should be a string");
-        json.put("returnValue", false);
+        errText = DisplayTable::invalidText();
         goto Done;
     }
-    else
-    {
-        toastId = json["toastId"].asString();
-        if(toastId.find("com.palm.",0) == std::string::npos && toastId.find("com.webos.", 0) == std::string::npos && toastId.find("com.lge.",0) == std::string::npos)
-        {
-            LOG_DEBUG("Invalid toastId");
-            json.put("errorText", "Invalid toastId");
-            json.put("returnValue", false);
-            goto Done;
-        }
-    }
 
-    if (!json.hasKey("readStatus"))
+    if(toastId.find("com.palm.",0) == std::string::npos && toastId.find("com.webos.", 0) == std::string::npos && toastId.find("com.lge.",0) == std::string::npos)
     {
-        LOG_DEBUG("Missing readStatus parameter");
-        json.put("errorText", "Missing readStatus parameter");
-        json.put("returnValue", false);
+        LOG_DEBUG("Invalid toastId");
+        errText = "Invalid toastId";
         goto Done;
     }
-    else if(json.hasKey("readStatus") && !json["readStatus"].isBoolean())
+
+    success = History::instance()->setReadStatus(toastId, status);
+
+    if(!success)
     {
-        LOG_DEBUG("readStatus should be a boolean value");
-        json.put("errorText", "readStatus should be a boolean value");
-        json.put("returnValue", false);
-        goto Done;
+        errText = "Failed to set status";
     }
-    else
+
+Done:
+    // The reply echoes the request
+    JsonWriter writer;
+    writer.beginObject();
+    if (request.toastId.set)
+        writer.member("toastId", request.toastId.value);
+    if (request.readStatus.set)
+        writer.member("readStatus", request.readStatus.value);
+    if (request.displayId.set)
+        writer.member("displayId", request.displayId.value);
+    if (!success)
+        writer.member("errorText", errText);
+    writer.member("returnValue", success).endObject();
+
+    if(!LSMessageReply( lshandle, msg, writer.c_str(), &lserror))
     {
-        status = json["readStatus"].asBool();
+        return false;
     }
 
-    success = History::instance()->setReadStatus(std::move(toastId), status);
+    return true;
+}
+
+//->Start of API documentation comment block
+/**
+@page com_webos_notification com.webos.notification
+@{
+@section com_webos_notification_getStats getStats
+
+Returns internal counters of the notification manager
 
-    if(!success)
+@par Parameters
+None
+
+@par Returns(Call)
+Name | Required | Type | Description
+-----|----------|------|------------
+returnValue | yes | Boolean | True
+iconCache | yes | Object | hits, misses, invalidations, entries and watches of the icon path cache
+callers | yes | Object | hits, misses and entries of the caller profile cache
+displays | yes | Object | maxDisplays and the toast counts, System UI readiness and number of toasts created of each display used so far
+rateLimit | yes | Object | Over quota policy, messages allowed, downgraded and rejected, and the counters of the most limited sources
+pending | yes | Object | Sizes and overflows of the queues held back until the UI is ready, the count, duration and main loop latency of their flushes, and the toast count changes and the posts they were coalesced into
+schemas | yes | Object | Number of compiled request schemas, time spent precompiling them at startup and reloads after they changed on disk
+
+@par Returns(Subscription)
+None
+
+@}
+*/
+//->End of API documentation comment block
+bool NotificationService::cb_getStats(LSHandle* lshandle, LSMessage *msg, void *user_data)
+{
+    LSErrorSafe lserror;
+
+    JUtil::Error error;
+    pbnjson::JValue request = JUtil::parse(LSMessageGetPayload(msg), "getStats", &error);
+
+    pbnjson::JValue json = pbnjson::Object();
+    if (request.isNull())
     {
-        json.put("errorText", "Failed to set status");
         json.put("returnValue", false);
+        json.put("errorText", "Message is not parsed");
     }
     else
     {
         json.put("returnValue", true);
-        if (displayId >= 0)
-        {
-            if (status)
-            {
-                toastCountVector[displayId].readCount++;
-                if (toastCountVector[displayId].unreadCount > 0)
-                    toastCountVector[displayId].unreadCount--;
-            }
-            else
-            {
-                toastCountVector[displayId].unreadCount++;
-                if (toastCountVector[displayId].readCount > 0)
-                    toastCountVector[displayId].readCount--;
-            }
-        }
+        json.put("iconCache", IconCache::instance().stats());
+        json.put("callers", CallerProfiles::instance().stats());
+        json.put("rateLimit", RateLimiter::instance().stats());
+        json.put("displays", DisplayTable::instance().stats());
+        json.put("pending", NotificationService::instance()->pendingStats());
+        json.put("schemas", JUtil::instance().schemaStats());
     }
 
-Done:
-    std::string result = pbnjson::JGenerator::serialize(json, pbnjson::JSchemaFragment("{}"));
-    if(!LSMessageReply( lshandle, msg, result.c_str(), &lserror))
+    std::string result = JUtil::jsonToString(std::move(json));
+    if(!LSMessageReply(lshandle, msg, result.c_str(), &lserror))
     {
         return false;
     }
@@ -17,6 +17,7 @@
 #ifndef __NOTIFICATIONSERVICE_H__
 #define __NOTIFICATIONSERVICE_H__
 
+#include <set>
 #include <string>
 #include <stdlib.h>
 #include <glib.h>
@@ -24,15 +25,17 @@
 #include <JUtil.h>
 #include <Logging.h>
 #include <pbnjson.hpp>
-#include <queue>
 #include <boost/signals2.hpp>
 
 #include "AppList.h"
 #include "Settings.h"
 #include "History.h"
 #include "LSUtils.h"
-
-#define NUM_DISPLAYS 2
+#include "PendingQueue.h"
+#include "NotificationRecord.h"
+#include "CallerProfile.h"
+#include "DisplayState.h"
+#include "RateLimiter.h"
 
 class NotificationService
 {
@@ -53,7 +56,9 @@ public:
     static bool cb_getToastCount(LSHandle* lshandle, LSMessage *msg, void *user_data);
     static bool cb_getToastList(LSHandle *lshandle, LSMessage *msg, void *user_data);
     static bool cb_setToastStatus(LSHandle *lshandle, LSMessage *msg, void *user_data);
+    static bool cb_getStats(LSHandle *lshandle, LSMessage *msg, void *user_data);
     static bool cb_createToast(LSHandle* lshandle, LSMessage *msg, void *user_data);
+    static bool cb_createToasts(LSHandle* lshandle, LSMessage *msg, void *user_data);
     static bool cb_createAlert(LSHandle* lshandle, LSMessage *msg, void *user_data);
     static bool cb_createAlertIsAllowed(LSHandle* lshandle, LSMessage *msg, void *user_data);
     static bool cb_closeToast(LSHandle* lshandle, LSMessage *msg, void *user_data);
@@ -66,9 +71,14 @@ public:
     static bool cb_removeAllNotification(LSHandle* lshandle, LSMessage *msg, void *user_data);
     static bool parseDoc(const char *docname);
 
-    bool postToastNotification(pbnjson::JValue toastNotificationPayload, bool staleMsg, bool persistentMsg, std::string &errorText);
-    bool postToastCountNotification(pbnjson::JValue toastCountPayload, bool staleMsg, bool persistentMsg, std::string &errorText);
-    bool postAlertNotification(pbnjson::JValue alertNotificationPayload, std::string &errorText);
+    bool postToastNotification(ToastRecord toast, bool staleMsg, bool persistentMsg, std::string &errorText);
+    bool postToastCountNotification(int displayId, const std::string& countPayload, bool staleMsg, bool persistentMsg, std::string &errorText);
+    /*! Post the counts of displayId to getToastCount subscribers. Changes
+     * are coalesced, one post per display per ToastCountInterval carries
+     * the latest counts.
+     */
+    void postToastCount(int displayId);
+    bool postAlertNotification(AlertRecord alert, std::string &errorText);
     void postNotification(pbnjson::JValue alertNotificationPayload, bool remove, bool removeAll);
 
     void setUIEnabled(bool enabled);
@@ -79,15 +89,32 @@ public:
 private:
     void onAlertStatus(bool enabled);
 
+    struct ToastRequest {
+        ToastRecord record;
+        std::string sourceId;       // copies for logging, record is moved on delivery
+        std::string message;
+        std::string toastId;
+        bool valid;
+        bool staleMsg;
+        bool persistentMsg;
+    };
+
+    /*! Request is CreateToastRequest or CreateToastsRequest::ToastsItem.
+     * batch is true for the toasts of a createToasts call.
+     */
+    template <typename Request>
+    bool buildToast(const CallerProfile& caller, const Request& request, ToastRequest& toast, std::string& errText,
+                    bool batch = false);
+
 private:
-    std::queue<pbnjson::JValue> alertMsgQueue;
+    PendingQueue<AlertRecord> alertMsgQueue;
 
     static bool alertRespondWithError(LSMessage* message, const std::string& sourceId, const std::string& alertId, const std::string& alertTitle, const std::string& alertMessage, const std::string& errorText);
-    static bool alertRespond(LSMessage* msg, const std::string& sourceId, const std::string& alertId, const std::string& alertTitle, const std::string& alertMessage, const pbnjson::JValue& postCreateAlert);
+    static bool alertRespond(LSMessage* msg, const std::string& sourceId, const std::string& alertId, const std::string& alertTitle, const std::string& alertMessage, AlertRecord postCreateAlert);
     static bool alertRespond(bool success, const std::string &errorText,
     LSMessageWrapper msg, const std::string& sourceId,
     const std::string& alertId, const std::string& alertTitle, const std::string& alertMessage,
-    const pbnjson::JValue& postCreateAlert = pbnjson::JValue());
+    AlertRecord postCreateAlert = AlertRecord());
 
 private:
     boost::signals2::scoped_connection m_connAlertStatus;
@@ -95,36 +122,67 @@ private:
     bool BLOCK_ALERT_NOTIFICATION;
     bool BLOCK_TOAST_NOTIFICATION;
 
-    class NotiMsgItem {
+    struct NotiMsgItem {
         pbnjson::JValue payload;
         bool remove;
         bool removeAll;
-
-        public:
-        NotiMsgItem(pbnjson::JValue payload, bool remove, bool removeAll);
-        pbnjson::JValue getPayLoad() { return payload; }
-        bool getRemove() { return remove; }
-        bool getRemoveAll() { return removeAll; }
     };
 
-    typedef class NotiMsgItem notiMsgItem;
-
-    std::queue<notiMsgItem*> notiMsgQueue;
-    std::queue<pbnjson::JValue> toastMsgQueue;
+    PendingQueue<NotiMsgItem> notiMsgQueue;
+    PendingQueue<ToastRecord> toastMsgQueue;
+
+    // Queued messages are posted a batch at a time from an idle callback
+    // once the UI is ready, so LS2 requests are still served meanwhile.
+    struct PendingFlush {
+        size_t alerts;          // messages left to post in this flush
+        size_t notifications;
+        size_t toasts;
+        guint source;
+        bool posting;           // set while the flush itself posts
+        gint64 started;         // monotonic us
+        gint64 lastIteration;
+        gint64 maxLatency;      // longest gap between two iterations of this flush
+
+        unsigned long flushes;
+        unsigned long items;
+        unsigned long expired;  // queued toasts dropped as expired
+        gint64 lastDuration;
+        gint64 maxDuration;
+        gint64 lastMaxLatency;
+    } m_flush;
+
+    // Displays whose counts changed since the last getToastCount post
+    struct CountPost {
+        std::set<int> displays;
+        guint timer;
+        unsigned long changes;
+        unsigned long posts;
+    } m_countPost;
+
+    void flushToastCounts();
+    static gboolean cbToastCountTimer(gpointer data);
+
+    void applyPendingQueueLimits();
+    void schedulePendingFlush();
+    static gboolean cbPendingFlush(gpointer data);
+    pbnjson::JValue pendingStats() const;
+    bool pushAlertMsgQueue(AlertRecord alert);
+    bool pushToastMsgQueue(ToastRecord toast);
 
     const char* getServiceName(LSMessage *msg);
-    void pushNotiMsgQueue(pbnjson::JValue payload, bool remove, bool removeAll);
-    void popNotiMsgQueue();
+
+    /*! Subscribers of getToastNotification and getToastCount which give a
+     * displayId get only the posts for that display; the others are on the
+     * broadcast key, the method's own, and get every post.
+     */
+    static std::string subscriptionKey(const char* method, int displayId);
+    static bool subscribeDisplay(LSHandle* lshandle, LSMessage* msg, const char* method, int displayId, LSError* lserror);
+    static unsigned int subscriberCount(LSHandle* lshandle, const char* method);
+    bool postDisplay(const char* method, int displayId, const char* payload, LSError* lserror);
+    bool pushNotiMsgQueue(pbnjson::JValue payload, bool remove, bool removeAll);
     static std::string m_user_name;
     static int m_display_id;
 
-    typedef struct Toast_Status_Count {
-            int readCount;
-            int unreadCount;
-    } toastCount;
-
-    static toastCount toastCountVector[NUM_DISPLAYS];
-
 protected:
     //LSMethod* get_private_methods() const;
     //LSMethod* get_public_methods() const;
@@ -0,0 +1,318 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __PENDINGQUEUE_H__
+#define __PENDINGQUEUE_H__
+
+#include <string>
+#include <vector>
+
+#include "Logging.h"
+
+/*! Bounded queue for messages held back until the UI is ready.
+ * Items go to a high or a normal priority lane, each a ring buffer, and
+ * high priority items are popped first. When maxItems or maxBytes would be
+ * exceeded the overflow policy decides what is dropped:
+ *  - DROP_OLDEST: the oldest item of either lane
+ *  - DROP_LOWEST_PRIORITY: the oldest normal item, high items only make
+ *    room for other high items
+ *  - COALESCE_SOURCE: a queued item of the same lane and source is replaced
+ *    by the new one if that fits the byte budget, otherwise like DROP_OLDEST
+ */
+template <typename T>
+class PendingQueue
+{
+public:
+    enum Policy {
+        DROP_OLDEST,
+        DROP_LOWEST_PRIORITY,
+        COALESCE_SOURCE
+    };
+
+    explicit PendingQueue(const char* name)
+        : m_name(name)
+        , m_maxItems(100)
+        , m_maxBytes(512 * 1024)
+        , m_policy(DROP_LOWEST_PRIORITY)
+        , m_bytes(0)
+        , m_seq(0)
+        , m_overflows(0)
+        , m_collapsed(0)
+    {
+        m_lanes[HIGH].resize(m_maxItems);
+        m_lanes[NORMAL].resize(m_maxItems);
+    }
+
+    void setLimits(size_t maxItems, size_t maxBytes, Policy policy)
+    {
+        m_maxItems = maxItems > 0 ? maxItems : 1;
+        m_maxBytes = maxBytes;
+        m_policy = policy;
+
+        for (Lane& lane : m_lanes)
+        {
+            // Keep the newest items if the lane no longer fits
+            while (lane.count > m_maxItems)
+                drop(lane);
+            lane.resize(m_maxItems);
+        }
+        while (m_maxBytes && m_bytes > m_maxBytes && !empty())
+            drop(oldestLane());
+    }
+
+    /*! Queue item. source is used for coalescing, leave it empty for items
+     * which must never be replaced. bytes is the approximate size of item.
+     * An item with a collapseKey removes the queued item of the same key,
+     * whatever the policy, and is then queued like any other item in its
+     * own lane. Returns false if the item was not queued, the queue is
+     * left as it was then.
+     */
+    bool push(T item, bool highPriority, const std::string& source, size_t bytes,
+              const std::string& collapseKey = std::string())
+    {
+        Lane& lane = m_lanes[highPriority ? HIGH : NORMAL];
+
+        Lane* supersededLane = NULL;
+        size_t superseded = 0;
+        if (!collapseKey.empty())
+            findCollapsed(collapseKey, supersededLane, superseded);
+
+        if (m_maxBytes && bytes > m_maxBytes)
+        {
+            overflow("rejected an item larger than the byte budget");
+            return false;
+        }
+
+        // Normal items can't make room by dropping high ones
+        if (m_policy == DROP_LOWEST_PRIORITY && !highPriority &&
+            !fitsBesideHigh(bytes, supersededLane == &m_lanes[HIGH] ? &m_lanes[HIGH].at(superseded) : NULL))
+        {
+            overflow("rejected an item, the queue is full of higher priority items");
+            return false;
+        }
+
+        if (supersededLane)
+        {
+            m_bytes -= supersededLane->at(superseded).bytes;
+            supersededLane->erase(superseded);
+            ++m_collapsed;
+        }
+
+        if (m_policy == COALESCE_SOURCE && !source.empty() && full(bytes))
+        {
+            for (size_t i = 0; i < lane.count; ++i)
+            {
+                Entry& entry = lane.at(i);
+                if (entry.source != source)
+                    continue;
+
+                // Otherwise make room like DROP_OLDEST
+                if (m_maxBytes && m_bytes - entry.bytes + bytes > m_maxBytes)
+                    break;
+
+                m_bytes = m_bytes - entry.bytes + bytes;
+                entry.item = std::move(item);
+                entry.collapseKey = collapseKey;
+                entry.bytes = bytes;
+                overflow("coalesced with a queued item of the same source");
+                return true;
+            }
+        }
+
+        while (full(bytes))
+        {
+            Lane* victim = NULL;
+            if (m_policy == DROP_LOWEST_PRIORITY)
+            {
+                if (m_lanes[NORMAL].count)
+                    victim = &m_lanes[NORMAL];
+                else if (highPriority)
+                    victim = &m_lanes[HIGH];
+            }
+            else
+            {
+                victim = &oldestLane();
+            }
+
+            if (!victim || !victim->count)
+            {
+                overflow("rejected an item, the queue is full of higher priority items");
+                return false;
+            }
+
+            drop(*victim);
+            overflow("dropped the oldest queued item");
+        }
+
+        Entry& entry = lane.at(lane.count++);
+        entry.item = std::move(item);
+        entry.source = source;
+        entry.collapseKey = collapseKey;
+        entry.bytes = bytes;
+        entry.seq = m_seq++;
+        m_bytes += bytes;
+        return true;
+    }
+
+    bool empty() const { return !m_lanes[HIGH].count && !m_lanes[NORMAL].count; }
+    size_t size() const { return m_lanes[HIGH].count + m_lanes[NORMAL].count; }
+    size_t bytes() const { return m_bytes; }
+    //! Number of items dropped, rejected or coalesced
+    unsigned long overflows() const { return m_overflows; }
+    //! Number of items replaced by a newer item of the same collapse key
+    unsigned long collapsed() const { return m_collapsed; }
+
+    //! Remove and return the next item, high priority first. Must not be empty.
+    T pop()
+    {
+        Lane& lane = m_lanes[HIGH].count ? m_lanes[HIGH] : m_lanes[NORMAL];
+        Entry& entry = lane.at(0);
+
+        T item = std::move(entry.item);
+        m_bytes -= entry.bytes;
+        lane.popFront();
+        return item;
+    }
+
+private:
+    enum { HIGH, NORMAL };
+
+    struct Entry {
+        T item;
+        std::string source;
+        std::string collapseKey;
+        size_t bytes;
+        unsigned long long seq;
+    };
+
+    struct Lane {
+        std::vector<Entry> slots;
+        size_t head;
+        size_t count;
+
+        Lane() : head(0), count(0) {}
+
+        Entry& at(size_t i) { return slots[(head + i) % slots.size()]; }
+
+        //! Remove the i-th item, later items move up
+        void erase(size_t i)
+        {
+            for (; i + 1 < count; ++i)
+                at(i) = std::move(at(i + 1));
+            at(count - 1) = Entry();
+            count--;
+        }
+
+        void popFront()
+        {
+            slots[head] = Entry();
+            head = (head + 1) % slots.size();
+            count--;
+        }
+
+        void resize(size_t capacity)
+        {
+            std::vector<Entry> resized(capacity);
+            for (size_t i = 0; i < count; ++i)
+                resized[i] = std::move(at(i));
+            slots.swap(resized);
+            head = 0;
+        }
+    };
+
+    bool full(size_t bytes) const
+    {
+        return size() >= m_maxItems || (m_maxBytes && m_bytes + bytes > m_maxBytes);
+    }
+
+    Lane& oldestLane()
+    {
+        Lane& high = m_lanes[HIGH];
+        Lane& normal = m_lanes[NORMAL];
+        if (!high.count)
+            return normal;
+        if (!normal.count)
+            return high;
+        return high.at(0).seq < normal.at(0).seq ? high : normal;
+    }
+
+    //! Find the queued item with collapseKey, the new item supersedes it
+    void findCollapsed(const std::string& collapseKey, Lane*& lane, size_t& index)
+    {
+        for (Lane& candidate : m_lanes)
+        {
+            for (size_t i = 0; i < candidate.count; ++i)
+            {
+                if (candidate.at(i).collapseKey != collapseKey)
+                    continue;
+
+                lane = &candidate;
+                index = i;
+                return;
+            }
+        }
+    }
+
+    //! True if an item of bytes fits with the high items but superseded
+    bool fitsBesideHigh(size_t bytes, const Entry* superseded)
+    {
+        Lane& high = m_lanes[HIGH];
+        size_t items = high.count;
+        size_t highBytes = 0;
+        for (size_t i = 0; i < high.count; ++i)
+            highBytes += high.at(i).bytes;
+
+        if (superseded)
+        {
+            items--;
+            highBytes -= superseded->bytes;
+        }
+        return items < m_maxItems && (!m_maxBytes || highBytes + bytes <= m_maxBytes);
+    }
+
+    void drop(Lane& lane)
+    {
+        m_bytes -= lane.at(0).bytes;
+        lane.popFront();
+    }
+
+    void overflow(const char* action)
+    {
+        // Log the 1st, 2nd, 4th, 8th... overflow so a flood can't flood the log too
+        ++m_overflows;
+        if ((m_overflows & (m_overflows - 1)) == 0)
+        {
+            LOG_WARNING(MSGID_PENDING_QUEUE_OVERFLOW, 3,
+                PMLOGKS("QUEUE", m_name),
+                PMLOGKFV("ITEMS", "%zu", size()),
+                PMLOGKFV("OVERFLOWS", "%lu", m_overflows),
+                "Pending queue limit reached, %s", action);
+        }
+    }
+
+    const char* m_name;
+    size_t m_maxItems;
+    size_t m_maxBytes;
+    Policy m_policy;
+
+    Lane m_lanes[2];
+    size_t m_bytes;
+    unsigned long long m_seq;
+    unsigned long m_overflows;
+    unsigned long m_collapsed;
+};
+
+#endif
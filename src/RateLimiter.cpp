@@ -0,0 +1,182 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "RateLimiter.h"
+#include "CallerProfile.h"
+#include "Logging.h"
+#include "Settings.h"
+#include "Utils.h"
+
+#include <glib.h>
+#include <algorithm>
+#include <vector>
+
+#define RATE_LIMIT_MAX_SOURCES 512
+#define RATE_LIMIT_STATS_TOP 16
+
+static const char* const s_quotaClassNames[] = { "default", "privileged", "aggregator" };
+
+RateLimiter::RateLimiter()
+    : m_allowed(0)
+    , m_downgraded(0)
+    , m_rejected(0)
+{
+}
+
+RateLimiter::Bucket& RateLimiter::bucket(const std::string& sourceId, gint64 now)
+{
+    auto it = m_buckets.find(sourceId);
+    if (it != m_buckets.end())
+        return it->second;
+
+    // Make room by forgetting the source which has been quiet the longest
+    if (m_buckets.size() >= RATE_LIMIT_MAX_SOURCES)
+    {
+        auto oldest = std::min_element(m_buckets.begin(), m_buckets.end(),
+            [](const std::pair<const std::string, Bucket>& a, const std::pair<const std::string, Bucket>& b)
+            { return a.second.refilled < b.second.refilled; });
+        m_buckets.erase(oldest);
+    }
+
+    Bucket& created = m_buckets[sourceId];
+    created.quotaClass = QUOTA_DEFAULT;
+    created.tokens = -1;    // filled up to the burst on the first refill
+    created.refilled = now;
+    created.allowed = 0;
+    created.downgraded = 0;
+    created.rejected = 0;
+    created.limited = false;
+    return created;
+}
+
+bool RateLimiter::take(const CallerProfile& caller, Bucket& b, gint64 now, bool batch)
+{
+    const RateQuota* quota;
+    if (caller.aggregator)
+    {
+        b.quotaClass = QUOTA_AGGREGATOR;
+        quota = &Settings::instance()->getAggregatorRateQuota();
+    }
+    else if (caller.privileged)
+    {
+        b.quotaClass = QUOTA_PRIVILEGED;
+        quota = &Settings::instance()->getPrivilegedRateQuota();
+    }
+    else
+    {
+        b.quotaClass = QUOTA_DEFAULT;
+        quota = &Settings::instance()->getDefaultRateQuota();
+    }
+
+    // The batch burst sits below the burst, single messages leave it alone
+    double capacity = quota->burst + quota->batchBurst;
+    if (b.tokens < 0)
+        b.tokens = capacity;
+    else
+        b.tokens = std::min(capacity, b.tokens + quota->rate * (now - b.refilled) / G_USEC_PER_SEC);
+    b.refilled = now;
+
+    if (quota->rate > 0 && b.tokens < (batch ? 1 : quota->batchBurst + 1))
+        return false;
+
+    if (quota->rate > 0)
+        b.tokens -= 1;
+    return true;
+}
+
+RateLimiter::Verdict RateLimiter::admit(const CallerProfile& caller, const std::string& sourceId, bool persistent, bool batch)
+{
+    gint64 now = g_get_monotonic_time();
+    // Any part of its own id passes as the sourceId of an untrusted caller, don't let each get a bucket
+    std::string key = caller.trusted() ? Utils::extractSourceIdFromCaller(sourceId) : caller.sourceId;
+    Bucket& b = bucket(key, now);
+
+    if (take(caller, b, now, batch))
+    {
+        b.limited = false;
+        b.allowed++;
+        m_allowed++;
+        return ALLOW;
+    }
+
+    Verdict verdict = (persistent && Settings::instance()->getRateLimitPolicy() == "downgrade") ? DOWNGRADE : REJECT;
+
+    // Log once per burst of limited messages, not for each of them
+    if (!b.limited)
+    {
+        LOG_WARNING(MSGID_RATE_LIMITED, 2,
+                    PMLOGKS("SOURCE_ID", key.c_str()),
+                    PMLOGKS("CLASS", s_quotaClassNames[b.quotaClass]),
+                    "Source is over its quota, %s", verdict == DOWNGRADE ? "not saving its messages" : "rejecting its messages");
+        b.limited = true;
+    }
+
+    if (verdict == DOWNGRADE)
+    {
+        b.downgraded++;
+        m_downgraded++;
+    }
+    else
+    {
+        b.rejected++;
+        m_rejected++;
+    }
+    return verdict;
+}
+
+pbnjson::JValue RateLimiter::stats() const
+{
+    pbnjson::JValue json = pbnjson::Object();
+    json.put("policy", Settings::instance()->getRateLimitPolicy());
+    json.put("allowed", static_cast<int64_t>(m_allowed));
+    json.put("downgraded", static_cast<int64_t>(m_downgraded));
+    json.put("rejected", static_cast<int64_t>(m_rejected));
+
+    // Most limited first, then busiest
+    typedef std::unordered_map<std::string, Bucket>::const_iterator Entry;
+    std::vector<Entry> entries;
+    entries.reserve(m_buckets.size());
+    for (Entry it = m_buckets.begin(); it != m_buckets.end(); ++it)
+        entries.push_back(it);
+
+    size_t top = std::min<size_t>(entries.size(), RATE_LIMIT_STATS_TOP);
+    std::partial_sort(entries.begin(), entries.begin() + top, entries.end(),
+        [](const Entry& a, const Entry& b)
+        {
+            unsigned long limitedA = a->second.downgraded + a->second.rejected;
+            unsigned long limitedB = b->second.downgraded + b->second.rejected;
+            if (limitedA != limitedB)
+                return limitedA > limitedB;
+            return a->second.allowed > b->second.allowed;
+        });
+
+    pbnjson::JValue sources = pbnjson::Array();
+    for (size_t i = 0; i < top; ++i)
+    {
+        const Bucket& b = entries[i]->second;
+        pbnjson::JValue source = pbnjson::Object();
+        source.put("sourceId", entries[i]->first);
+        source.put("class", s_quotaClassNames[b.quotaClass]);
+        source.put("allowed", static_cast<int64_t>(b.allowed));
+        source.put("downgraded", static_cast<int64_t>(b.downgraded));
+        source.put("rejected", static_cast<int64_t>(b.rejected));
+        source.put("tokens", b.tokens < 0 ? 0.0 : b.tokens);
+        sources.append(source);
+    }
+    json.put("sources", sources);
+    json.put("trackedSources", static_cast<int64_t>(m_buckets.size()));
+    return json;
+}
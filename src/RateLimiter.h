@@ -0,0 +1,91 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __RATELIMITER_H__
+#define __RATELIMITER_H__
+
+#include <string>
+#include <unordered_map>
+#include <glib.h>
+#include <pbnjson.hpp>
+
+#include "Singleton.hpp"
+
+struct CallerProfile;
+
+/*! Token bucket per source, so one source posting in a loop can't flood
+ * history and the UI. Privileged and aggregator callers post for others,
+ * their buckets are keyed by the normalized source id of the message. Any
+ * other caller may only name a part of its own id, so its bucket is keyed
+ * by the caller's source id. Buckets are refilled at the rate of the
+ * caller's quota class (aggregator, privileged or default, from the
+ * RateLimit settings). When a bucket is empty the message is rejected, or
+ * with the downgrade policy a persistent message is still shown but not
+ * saved.
+ *
+ * Every message costs one token. A bucket holds the quota's batch burst on
+ * top of its burst, and only the messages of a batch request may dip into
+ * that headroom, so a boot burst of createToasts fits without raising the
+ * rate.
+ */
+class RateLimiter : public Singleton<RateLimiter>
+{
+public:
+    enum Verdict {
+        ALLOW,
+        DOWNGRADE,  // deliver, but don't save to history
+        REJECT
+    };
+
+    RateLimiter();
+
+    /*! Charge one message of sourceId, posted by caller. batch is true for
+     * the messages of a batch request.
+     */
+    Verdict admit(const CallerProfile& caller, const std::string& sourceId, bool persistent, bool batch = false);
+
+    //! Totals and the noisiest sources
+    pbnjson::JValue stats() const;
+
+private:
+    enum QuotaClass {
+        QUOTA_DEFAULT,
+        QUOTA_PRIVILEGED,
+        QUOTA_AGGREGATOR
+    };
+
+    struct Bucket {
+        QuotaClass quotaClass;
+        double tokens;
+        gint64 refilled;
+        unsigned long allowed;
+        unsigned long downgraded;
+        unsigned long rejected;
+        bool limited;           // last message was over quota
+    };
+
+    Bucket& bucket(const std::string& sourceId, gint64 now);
+    //! Refill b at the quota of caller and take a token, false if there is none
+    bool take(const CallerProfile& caller, Bucket& b, gint64 now, bool batch);
+
+    std::unordered_map<std::string, Bucket> m_buckets;
+
+    unsigned long m_allowed;
+    unsigned long m_downgraded;
+    unsigned long m_rejected;
+};
+
+#endif
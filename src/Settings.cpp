@@ -32,7 +32,10 @@
 
 static Settings* s_settings_instance = 0;
 
-Settings::Settings():m_disableToastTimestamp(0),m_thresholdTimer(120),m_retentionPeriod(0)
+Settings::Settings():m_disableToastTimestamp(0),m_thresholdTimer(120),m_retentionPeriod(0),m_maxDisplays(8),m_toastCountInterval(33)
+	,m_pendingQueueMaxItems(100),m_pendingQueueMaxBytes(512 * 1024),m_pendingQueuePolicy("dropLowestPriority")
+	,m_defaultRateQuota{2, 10, 0},m_privilegedRateQuota{10, 50, 50},m_aggregatorRateQuota{20, 100, 100},m_rateLimitPolicy("reject")
+	,m_revision(0)
 {
 	s_settings_instance = this;
 	loadSettings();
@@ -52,6 +55,26 @@ Settings* Settings::instance()
 	return s_settings_instance;
 }
 
+void Settings::loadRateQuota(pbnjson::JValue quota, RateQuota& target)
+{
+	if(!quota.isObject())
+		return;
+
+	// A rate of 0 turns the limit off, the burst must let at least one message through
+	if(quota["Rate"].isNumber() && quota["Rate"].asNumber<double>() >= 0)
+	{
+		target.rate = quota["Rate"].asNumber<double>();
+	}
+	if(quota["Burst"].isNumber() && quota["Burst"].asNumber<double>() >= 1)
+	{
+		target.burst = quota["Burst"].asNumber<double>();
+	}
+	if(quota["BatchBurst"].isNumber() && quota["BatchBurst"].asNumber<double>() >= 0)
+	{
+		target.batchBurst = quota["BatchBurst"].asNumber<double>();
+	}
+}
+
 void Settings::loadSettings()
 {
 	char* settingsData;
@@ -59,6 +82,8 @@ void Settings::loadSettings()
 	pbnjson::JValue sData;
 	JUtil::Error error;
 
+	m_revision++;
+
         settingsData = Utils::readFile(s_settingsFile);
 	if(settingsData)
 	{
@@ -87,15 +112,80 @@ void Settings::loadSettings()
 		m_retentionPeriod = retentionPeriod;
 	}
 
+	int maxDisplays = sData["MaxDisplays"].asNumber<int32_t>();
+	if(maxDisplays > 0)
+	{
+		m_maxDisplays = maxDisplays;
+	}
+
+	// Anything over a second would make the badge visibly lag
+	if(sData["ToastCountInterval"].isNumber())
+	{
+		int interval = sData["ToastCountInterval"].asNumber<int32_t>();
+		if(interval >= 0 && interval <= 1000)
+		{
+			m_toastCountInterval = interval;
+		}
+		else
+		{
+			LOG_WARNING(MSGID_SETTINGS_INVALID_VALUE, 1, PMLOGKFV("ToastCountInterval", "%d", interval), "Toast count interval out of range in %s", __PRETTY_FUNCTION__ );
+		}
+	}
+
 	aggregators = sData["NotificationAggregator"];
 	if(aggregators.isArray())
 	{
+		m_notificationAggregator.clear();
 		const int aSize = aggregators.arraySize();
 		for(ssize_t index = 0; index < aSize; ++index) {
 			m_notificationAggregator.push_back(aggregators[index].asString());
 		}
 	}
 
+	pbnjson::JValue pendingQueue = sData["PendingQueue"];
+	if(pendingQueue.isObject())
+	{
+		int maxItems = pendingQueue["MaxItems"].asNumber<int32_t>();
+		if(maxItems > 0)
+		{
+			m_pendingQueueMaxItems = maxItems;
+		}
+
+		// 0 disables the byte budget
+		if(pendingQueue["MaxBytes"].isNumber() && pendingQueue["MaxBytes"].asNumber<int32_t>() >= 0)
+		{
+			m_pendingQueueMaxBytes = pendingQueue["MaxBytes"].asNumber<int32_t>();
+		}
+
+		std::string policy = pendingQueue["OverflowPolicy"].asString();
+		if(policy == "dropOldest" || policy == "dropLowestPriority" || policy == "coalesceSource")
+		{
+			m_pendingQueuePolicy = policy;
+		}
+		else if(!policy.empty())
+		{
+			LOG_WARNING(MSGID_SETTINGS_INVALID_VALUE, 1, PMLOGKS("OverflowPolicy", policy.c_str()), "Unknown pending queue overflow policy in %s", __PRETTY_FUNCTION__ );
+		}
+	}
+
+	pbnjson::JValue rateLimit = sData["RateLimit"];
+	if(rateLimit.isObject())
+	{
+		loadRateQuota(rateLimit["Default"], m_defaultRateQuota);
+		loadRateQuota(rateLimit["Privileged"], m_privilegedRateQuota);
+		loadRateQuota(rateLimit["Aggregator"], m_aggregatorRateQuota);
+
+		std::string policy = rateLimit["OverQuotaPolicy"].asString();
+		if(policy == "reject" || policy == "downgrade")
+		{
+			m_rateLimitPolicy = policy;
+		}
+		else if(!policy.empty())
+		{
+			LOG_WARNING(MSGID_SETTINGS_INVALID_VALUE, 1, PMLOGKS("OverQuotaPolicy", policy.c_str()), "Unknown rate limit policy in %s", __PRETTY_FUNCTION__ );
+		}
+	}
+
 	bool result;
 	LSError lsError;
 	LSErrorInit(&lsError);
@@ -336,22 +426,15 @@ bool Settings::enableToastNotificationForApp(const std::string& appId)
 	return true;
 }
 
-bool Settings::isPartOfAggregators(std::string sId)
+bool Settings::isPartOfAggregators(const std::string& sId) const
 {
-	bool isExist = false;
-
-	for(std::vector<std::string>::iterator it = m_notificationAggregator.begin(); it != m_notificationAggregator.end(); ++it)
+	for(const std::string& item : m_notificationAggregator)
 	{
-		std::string item = (*it);
-		if(sId.find(item,0) == std::string::npos) {
-			isExist = false;
-		}
-		else {
+		if(sId.find(item, 0) != std::string::npos)
 			return true;
-		}
 	}
 
-	return isExist;
+	return false;
 }
 
 int Settings::getRetentionPeriod()
@@ -374,7 +457,7 @@ std::string Settings::getDefaultIcon(const std::string type)
 	}
 }
 
-bool Settings::isPrivilegedSource(const std::string &callerId)
+bool Settings::isPrivilegedSource(const std::string &callerId) const
 {
 	if(callerId.find("com.palm.",0) == std::string::npos && callerId.find("com.webos.", 0) == std::string::npos && callerId.find("com.lge.",0) == std::string::npos)
 	{
@@ -15,14 +15,19 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "SystemTime.h"
+#include <cstdlib>
 #include "JUtil.h"
 #include "LSUtils.h"
 #include "NotificationService.h"
 #include "Logging.h"
 
+// Difference between the reported and the expected time that counts as a jump
+#define SYSTEM_TIME_JUMP_S 5
+
 SystemTime::SystemTime()
     : m_isSynced(false)
     , m_utc_time(0)
+    , m_utc_received(0)
 {
 }
 
@@ -43,16 +48,26 @@ void SystemTime::startSync()
 
 void SystemTime::setSync(bool sync, std::string time_source, int64_t utc_time)
 {
+    gint64 now = g_get_monotonic_time();
+
     if (sync == isSynced())
     {
-        // no populate signal
+        // no populate signal, unless the synced clock was moved
+        int64_t expected = m_utc_time + (now - m_utc_received) / G_USEC_PER_SEC;
+        bool jumped = sync && m_utc_time && utc_time && std::llabs(utc_time - expected) > SYSTEM_TIME_JUMP_S;
+
         m_utc_time = utc_time;
+        m_utc_received = now;
         m_time_source = time_source;
+
+        if (jumped)
+            sigSync(true);
         return;
     }
 
     m_isSynced = sync;
     m_utc_time = std::move(utc_time);
+    m_utc_received = now;
     m_time_source = std::move(time_source);
 
     sigSync(sync);
@@ -19,6 +19,7 @@
 
 #include <luna-service2/lunaservice.h>
 #include <boost/signals2.hpp>
+#include <glib.h>
 
 #include "Singleton.hpp"
 
@@ -33,6 +34,9 @@ public:
     int64_t getUtcTime() const;
     std::string getTimeSource() const;
 
+    /*! Sync state changed. Also emitted with true when the clock of a synced
+     * system jumps, e.g. it was set or caught up after a suspend.
+     */
     boost::signals2::signal<void (bool)> sigSync;
 
 protected:
@@ -44,6 +48,7 @@ protected:
 private:
     bool m_isSynced;
     int64_t m_utc_time;
+    gint64 m_utc_received;  // monotonic us when m_utc_time was reported
     std::string m_time_source;
 };
 
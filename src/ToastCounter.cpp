@@ -0,0 +1,256 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ToastCounter.h"
+#include "DbJournal.h"
+#include "DisplayState.h"
+#include "NotificationService.h"
+#include "Settings.h"
+#include "ToastIndex.h"
+#include "JUtil.h"
+#include "LSUtils.h"
+#include "Logging.h"
+
+#define TOAST_COUNTER_RECONCILE_S 900
+#define TOAST_COUNTER_READY_RECONCILE_S 3600
+#define TOAST_COUNTER_SOON_MS 2000
+
+ToastCounter::ToastCounter()
+    : m_handle(NULL)
+    , m_index(NULL)
+    , m_journal(NULL)
+    , m_timer(0)
+    , m_soonTimer(0)
+    , m_generation(0)
+    , m_inflight(0)
+{
+}
+
+ToastCounter::~ToastCounter()
+{
+    if (m_timer)
+        g_source_remove(m_timer);
+    if (m_soonTimer)
+        g_source_remove(m_soonTimer);
+}
+
+void ToastCounter::start(LSHandle* lshandle, const std::string& kind, ToastIndex& index, DbJournal& journal)
+{
+    m_handle = lshandle;
+    m_kind = kind;
+    m_index = &index;
+    m_journal = &journal;
+
+    m_connCountChanged = index.sigCountChanged.connect(
+        std::bind(&ToastCounter::onCountChanged, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
+    m_connReady = index.sigReady.connect(std::bind(&ToastCounter::onIndexReady, this));
+    m_connLost = journal.sigLost.connect(std::bind(&ToastCounter::reconcileSoon, this));
+
+    reconcile();
+    m_timer = g_timeout_add_seconds(TOAST_COUNTER_RECONCILE_S, ToastCounter::cbReconcile, this);
+}
+
+void ToastCounter::reconcile()
+{
+    if (m_index->isReady())
+    {
+        // Compared with the index, so db8 must have every write it has
+        if (!m_journal->idle())
+        {
+            reconcileSoon();
+            return;
+        }
+    }
+    else
+    {
+        // Queued history writes must reach db8 before it is counted; LS2
+        // keeps the order of the calls made on one handle.
+        m_journal->flush();
+    }
+
+    m_generation++;
+    m_inflight = 0;
+    m_deltas.clear();
+
+    int displays = static_cast<int>(Settings::instance()->getMaxDisplays());
+    for (int displayId = 0; displayId < displays; ++displayId)
+    {
+        for (bool readStatus : { false, true })
+        {
+            LSErrorSafe lserror;
+
+            pbnjson::JValue query = pbnjson::JObject{{"from", m_kind},
+                {"where", pbnjson::JArray{{{"prop", "displayId"}, {"op", "="}, {"val", displayId}},
+                                          {{"prop", "readStatus"}, {"op", "="}, {"val", readStatus}}}},
+                {"select", pbnjson::JArray{"_id"}},
+                {"limit", 1}};
+            pbnjson::JValue params = pbnjson::JObject{{"query", query}, {"count", true}};
+
+            Query* data = new Query{ this, m_generation, displayId, readStatus };
+            if (!LSCallOneReply(m_handle, "palm://com.palm.db/find",
+                                JUtil::jsonToString(std::move(params)).c_str(),
+                                ToastCounter::cbCount, data, NULL, &lserror))
+            {
+                LOG_WARNING(MSGID_DB8_CALL_FAILED, 0, "Counting toasts failed in %s", __PRETTY_FUNCTION__);
+                delete data;
+                continue;
+            }
+            m_inflight++;
+        }
+    }
+}
+
+void ToastCounter::reconcileSoon()
+{
+    if (m_soonTimer || !m_handle)
+        return;
+
+    m_soonTimer = g_timeout_add(TOAST_COUNTER_SOON_MS, ToastCounter::cbReconcileSoon, this);
+}
+
+gboolean ToastCounter::cbReconcile(gpointer data)
+{
+    ToastCounter* counter = static_cast<ToastCounter*>(data);
+    counter->reconcile();
+    return G_SOURCE_CONTINUE;
+}
+
+gboolean ToastCounter::cbReconcileSoon(gpointer data)
+{
+    ToastCounter* counter = static_cast<ToastCounter*>(data);
+    counter->m_soonTimer = 0;
+    counter->reconcile();
+    return G_SOURCE_REMOVE;
+}
+
+bool ToastCounter::cbCount(LSHandle* lshandle, LSMessage* message, void* user_data)
+{
+    Query* query = static_cast<Query*>(user_data);
+    ToastCounter* counter = query->counter;
+
+    if (query->generation != counter->m_generation)
+    {
+        delete query;
+        return true;
+    }
+
+    counter->m_inflight--;
+
+    JUtil::Error error;
+    pbnjson::JValue response = JUtil::parse(LSMessageGetPayload(message), "", &error);
+    if (response.isNull() || !response["returnValue"].asBool() || !response["count"].isNumber())
+    {
+        // Keep the current count, the next reconcile tries again
+        LOG_WARNING(MSGID_DB8_CALL_FAILED, 0, "Call to Db8 to count toasts failed in %s", __PRETTY_FUNCTION__);
+    }
+    else
+    {
+        const DisplayState* display = DisplayTable::instance().find(query->displayId);
+        int read = display ? display->readCount : 0;
+        int unread = display ? display->unreadCount : 0;
+
+        const std::pair<int, int>& delta = counter->m_deltas[query->displayId];
+        if (query->readStatus)
+            read = response["count"].asNumber<int>() + delta.first;
+        else
+            unread = response["count"].asNumber<int>() + delta.second;
+
+        // db8 is the record, the loaded index should never differ from it
+        if (counter->m_index->isReady() && display && (read != display->readCount || unread != display->unreadCount))
+        {
+            LOG_WARNING(MSGID_TOAST_COUNT_DRIFT, 3,
+                        PMLOGKFV("DISPLAY_ID", "%d", query->displayId),
+                        PMLOGKFV("READ", "%d", read),
+                        PMLOGKFV("UNREAD", "%d", unread),
+                        "Toast counts differ from db8, taking db8's");
+        }
+
+        counter->set(query->displayId, read, unread);
+    }
+
+    if (!counter->m_inflight)
+        counter->m_deltas.clear();
+
+    delete query;
+    return true;
+}
+
+void ToastCounter::onCountChanged(int displayId, int readDelta, int unreadDelta)
+{
+    DisplayState* display = DisplayTable::instance().get(displayId);
+    if (!display)
+        return;
+
+    if (m_inflight)
+    {
+        m_deltas[displayId].first += readDelta;
+        m_deltas[displayId].second += unreadDelta;
+    }
+
+    set(displayId, display->readCount + readDelta, display->unreadCount + unreadDelta);
+}
+
+void ToastCounter::onIndexReady()
+{
+    // History may have started loading it again straight away
+    if (!m_index->isReady())
+        return;
+
+    // The index holds every row now, its counts are exact. Drop the db8
+    // counts still in flight, they may predate changes the index has.
+    m_generation++;
+    m_inflight = 0;
+    m_deltas.clear();
+
+    // From now on the counts follow the index, db8 is only checked for drift
+    if (m_timer)
+        g_source_remove(m_timer);
+    m_timer = g_timeout_add_seconds(TOAST_COUNTER_READY_RECONCILE_S, ToastCounter::cbReconcile, this);
+    if (m_soonTimer)
+    {
+        g_source_remove(m_soonTimer);
+        m_soonTimer = 0;
+    }
+
+    int displays = static_cast<int>(Settings::instance()->getMaxDisplays());
+    for (int displayId = 0; displayId < displays; ++displayId)
+    {
+        auto it = m_index->counts().find(displayId);
+        if (it != m_index->counts().end())
+            set(displayId, it->second.read, it->second.unread);
+        else
+            set(displayId, 0, 0);
+    }
+}
+
+void ToastCounter::set(int displayId, int read, int unread)
+{
+    read = read < 0 ? 0 : read;
+    unread = unread < 0 ? 0 : unread;
+
+    // Displays without toasts don't need an entry
+    if (!read && !unread && !DisplayTable::instance().find(displayId))
+        return;
+
+    DisplayState* display = DisplayTable::instance().get(displayId);
+    if (!display || (display->readCount == read && display->unreadCount == unread))
+        return;
+
+    display->readCount = read;
+    display->unreadCount = unread;
+
+    NotificationService::instance()->postToastCount(displayId);
+}
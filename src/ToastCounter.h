@@ -0,0 +1,91 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __TOASTCOUNTER_H__
+#define __TOASTCOUNTER_H__
+
+#include <map>
+#include <string>
+#include <glib.h>
+#include <luna-service2/lunaservice.h>
+#include <boost/signals2.hpp>
+
+class DbJournal;
+class ToastIndex;
+
+/*! Keeps the read and unread counts of the DisplayTable in step with the
+ * history kind, so getToastCount is right after a restart.
+ * - At startup the counts of every display are fetched with db8 count
+ *   queries on the DisplayIdAndReadStatus index, long before the history
+ *   index has read every row.
+ * - Puts, merges and deletes are applied as ToastIndex reports them.
+ * - Until the index is loaded, db8 is counted again every
+ *   TOAST_COUNTER_RECONCILE_S and soon after changes the index couldn't
+ *   follow. Changes made while those queries are in flight are added to
+ *   their results.
+ * - Once the index is loaded its counts are taken over. db8 is still
+ *   counted every TOAST_COUNTER_READY_RECONCILE_S, and soon after the
+ *   journal lost writes, to catch drift. Those counts are taken only
+ *   while no history write is queued or in flight, so db8 has every
+ *   change the index has.
+ */
+class ToastCounter
+{
+public:
+    ToastCounter();
+    ~ToastCounter();
+
+    void start(LSHandle* lshandle, const std::string& kind, ToastIndex& index, DbJournal& journal);
+
+    //! Count db8 again now, or shortly if history writes are still pending
+    void reconcile();
+    //! Count db8 again shortly, e.g. for deletes and merges of rows not loaded yet
+    void reconcileSoon();
+
+private:
+    struct Query {
+        ToastCounter* counter;
+        unsigned int generation;
+        int displayId;
+        bool readStatus;
+    };
+
+    void onCountChanged(int displayId, int readDelta, int unreadDelta);
+    void onIndexReady();
+    void set(int displayId, int read, int unread);
+
+    static bool cbCount(LSHandle* lshandle, LSMessage* message, void* user_data);
+    static gboolean cbReconcile(gpointer data);
+    static gboolean cbReconcileSoon(gpointer data);
+
+    LSHandle* m_handle;
+    std::string m_kind;
+    ToastIndex* m_index;
+    DbJournal* m_journal;
+
+    guint m_timer;
+    guint m_soonTimer;
+
+    unsigned int m_generation;      // replies of older generations are ignored
+    size_t m_inflight;              // replies outstanding
+    std::map<int, std::pair<int, int>> m_deltas;    // read/unread changes made meanwhile
+
+    boost::signals2::scoped_connection m_connCountChanged;
+    boost::signals2::scoped_connection m_connReady;
+    boost::signals2::scoped_connection m_connLost;
+};
+
+#endif
@@ -0,0 +1,492 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ToastIndex.h"
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include "LSUtils.h"
+#include "Utils.h"
+#include "JUtil.h"
+#include "Logging.h"
+
+#define TOAST_INDEX_PAGE_SIZE 500
+
+// Marks paging cursors of the index, db8 cursors never start with it
+#define TOAST_INDEX_CURSOR_PREFIX "m:"
+
+// Rows loaded from db8 are older than anything put while loading, so they
+// take keys from the low range to keep insertion order.
+#define TOAST_INDEX_LIVE_KEY_BASE (1ULL << 40)
+
+//! 1 if row is counted as read, 0 as unread, -1 if it isn't counted
+static int readState(const pbnjson::JValue& row, int& displayId)
+{
+    // Only toasts which track their read status are counted
+    if (!row["displayId"].isNumber() || !row["readStatus"].isBoolean())
+        return -1;
+
+    displayId = row["displayId"].asNumber<int>();
+    return row["readStatus"].asBool() ? 1 : 0;
+}
+
+ToastIndex::ToastIndex()
+    : m_nextLoadKey(1)
+    , m_nextKey(TOAST_INDEX_LIVE_KEY_BASE)
+    , m_ready(false)
+    , m_loading(false)
+    , m_handle(NULL)
+{
+}
+
+ToastIndex::~ToastIndex()
+{
+}
+
+void ToastIndex::load(LSHandle* lshandle, const std::string& kind)
+{
+    if (m_ready || m_loading)
+        return;
+
+    m_handle = lshandle;
+    m_kind = kind;
+    m_loading = true;
+    requestPage(lshandle, "");
+}
+
+bool ToastIndex::reload()
+{
+    if (m_loading || !m_handle)
+        return false;
+
+    LOG_DEBUG("[ToastIndex] reloading %zu history rows", m_rows.size());
+
+    clear();
+    m_ready = false;
+    m_loading = true;
+    requestPage(m_handle, "");
+    return true;
+}
+
+void ToastIndex::clear()
+{
+    m_rows.clear();
+    m_byTimestamp.clear();
+    m_bySource.clear();
+    m_byDisplay.clear();
+    m_byCollapseKey.clear();
+    m_byExpire.clear();
+    m_counts.clear();
+    m_replay.clear();
+    m_nextLoadKey = 1;
+}
+
+void ToastIndex::requestPage(LSHandle* lshandle, const std::string& page)
+{
+    LSErrorSafe lserror;
+
+    pbnjson::JValue query = pbnjson::JObject{{"from", m_kind}, {"limit", TOAST_INDEX_PAGE_SIZE}};
+    if (!page.empty())
+        query.put("page", page);
+
+    pbnjson::JValue find_query = pbnjson::Object();
+    find_query.put("query", query);
+
+    if (LSCallOneReply(lshandle, "palm://com.palm.db/find",
+                       JUtil::jsonToString(std::move(find_query)).c_str(),
+                       ToastIndex::cbLoad, this, NULL, &lserror) == false)
+    {
+        LOG_WARNING(MSGID_DB8_CALL_FAILED, 0, "Loading history index failed in %s", __PRETTY_FUNCTION__ );
+        m_loading = false;
+        m_replay.clear();
+    }
+}
+
+bool ToastIndex::cbLoad(LSHandle* lshandle, LSMessage *message, void *user_data)
+{
+    ToastIndex* index = static_cast<ToastIndex*>(user_data);
+
+    JUtil::Error error;
+    pbnjson::JValue response = JUtil::parse(LSMessageGetPayload(message), "", &error);
+
+    if (response.isNull() || !response["returnValue"].asBool())
+    {
+        LOG_WARNING(MSGID_DB8_CALL_FAILED, 0, "Call to Db8 to load history index failed in %s", __PRETTY_FUNCTION__ );
+        index->m_loading = false;
+        index->m_replay.clear();
+        return true;
+    }
+
+    pbnjson::JValue results = response["results"];
+    for (ssize_t i = 0; i < results.arraySize(); ++i)
+    {
+        pbnjson::JValue row = results[i];
+
+        // Already known from a put made while loading
+        std::string timestamp = row["timestamp"].asString();
+        Utils::advanceTimestamp(timestamp);
+        if (!timestamp.empty() && index->m_byTimestamp.count(timestamp))
+            continue;
+
+        bool deleted = false;
+        for (auto &op : index->m_replay)
+        {
+            if (!matches(row, op.first))
+                continue;
+
+            if (op.second.isNull())
+            {
+                deleted = true;
+                break;
+            }
+
+            for (auto prop : op.second.children())
+                row.put(prop.first.asString(), prop.second);
+        }
+
+        if (!deleted)
+            index->insert(index->m_nextLoadKey++, row, false);
+    }
+
+    if (response.hasKey("next"))
+    {
+        index->requestPage(lshandle, response["next"].asString());
+        return true;
+    }
+
+    index->m_loading = false;
+    index->m_ready = true;
+    index->m_replay.clear();
+
+    LOG_DEBUG("[ToastIndex] loaded %zu history rows", index->m_rows.size());
+    index->sigReady();
+    return true;
+}
+
+void ToastIndex::put(const pbnjson::JValue& row)
+{
+    // Callers keep modifying their payloads after saving them
+    insert(m_nextKey++, row.duplicate());
+}
+
+void ToastIndex::del(const pbnjson::JValue& query)
+{
+    for (RowKey key : candidates(query))
+    {
+        if (matches(m_rows.at(key), query))
+            erase(key);
+    }
+
+    if (m_loading)
+        m_replay.emplace_back(query, pbnjson::JValue());
+}
+
+void ToastIndex::merge(const pbnjson::JValue& query, const pbnjson::JValue& props)
+{
+    for (RowKey key : candidates(query))
+    {
+        pbnjson::JValue row = m_rows.at(key);
+        if (!matches(row, query))
+            continue;
+
+        int beforeDisplay = 0;
+        int before = readState(row, beforeDisplay);
+
+        // Indexed props may change, e.g. the displayId of a collapsed toast
+        erase(key, false);
+        for (auto prop : props.children())
+            row.put(prop.first.asString(), prop.second);
+        insert(key, row, false);
+
+        // Signal only a change in what the row counts for
+        int afterDisplay = 0;
+        int after = readState(row, afterDisplay);
+        if (before == after && beforeDisplay == afterDisplay)
+            continue;
+        if (before >= 0)
+            sigCountChanged(beforeDisplay, before ? -1 : 0, before ? 0 : -1);
+        if (after >= 0)
+            sigCountChanged(afterDisplay, after ? 1 : 0, after ? 0 : 1);
+    }
+
+    if (m_loading)
+        m_replay.emplace_back(query, props);
+}
+
+bool ToastIndex::byDisplay(int displayId, const pbnjson::JValue& readStatus, size_t limit,
+                           std::string& cursor, std::vector<pbnjson::JValue>& rows) const
+{
+    RowKey after = 0;
+
+    if (!cursor.empty())
+    {
+        if (!isCursor(cursor))
+            return false;
+
+        char *end = NULL;
+        const char *start = cursor.c_str() + strlen(TOAST_INDEX_CURSOR_PREFIX);
+        after = strtoull(start, &end, 10);
+        if (end == start || *end != '\0')
+            return false;
+    }
+
+    cursor.clear();
+
+    auto it = m_byDisplay.find(displayId);
+    if (it == m_byDisplay.end())
+        return true;
+
+    for (auto key = it->second.upper_bound(after); key != it->second.end(); ++key)
+    {
+        const pbnjson::JValue& row = m_rows.at(*key);
+        if (!readStatus.isNull() && row["readStatus"] != readStatus)
+            continue;
+
+        if (limit && rows.size() == limit)
+        {
+            cursor = TOAST_INDEX_CURSOR_PREFIX + Utils::toString(*std::prev(key));
+            break;
+        }
+
+        rows.push_back(row);
+    }
+
+    return true;
+}
+
+bool ToastIndex::isCursor(const std::string& cursor)
+{
+    return cursor.compare(0, strlen(TOAST_INDEX_CURSOR_PREFIX), TOAST_INDEX_CURSOR_PREFIX) == 0;
+}
+
+static std::string collapseIndexKey(const pbnjson::JValue& row)
+{
+    if (!row["collapseKey"].isString() || !row["sourceId"].isString())
+        return std::string();
+    return row["sourceId"].asString() + '\n' + row["collapseKey"].asString();
+}
+
+std::string ToastIndex::findCollapsed(const std::string& sourceId, const std::string& collapseKey) const
+{
+    auto it = m_byCollapseKey.find(sourceId + '\n' + collapseKey);
+    if (it == m_byCollapseKey.end())
+        return std::string();
+    return m_rows.at(it->second)["timestamp"].asString();
+}
+
+static bool expireTime(const pbnjson::JValue& row, int64_t& expire)
+{
+    pbnjson::JValue value = row["schedule"]["expire"];
+    if (!value.isNumber())
+        return false;
+
+    expire = value.asNumber<int64_t>();
+    return true;
+}
+
+int64_t ToastIndex::nextExpire() const
+{
+    return m_byExpire.empty() ? 0 : m_byExpire.begin()->first;
+}
+
+std::vector<std::string> ToastIndex::expired(int64_t now) const
+{
+    std::vector<std::string> timestamps;
+    for (auto it = m_byExpire.begin(); it != m_byExpire.end() && it->first < now; ++it)
+    {
+        const pbnjson::JValue& row = m_rows.at(it->second);
+        if (row["timestamp"].isString())
+            timestamps.push_back(row["timestamp"].asString());
+    }
+    return timestamps;
+}
+
+void ToastIndex::count(const pbnjson::JValue& row, int delta, bool notify)
+{
+    int displayId;
+    int read = readState(row, displayId);
+    if (read < 0)
+        return;
+
+    Counts& counts = m_counts[displayId];
+    (read ? counts.read : counts.unread) += delta;
+
+    if (notify)
+        sigCountChanged(displayId, read ? delta : 0, read ? 0 : delta);
+}
+
+void ToastIndex::insert(RowKey key, const pbnjson::JValue& row, bool notify)
+{
+    m_rows[key] = row;
+    count(row, 1, notify);
+
+    if (row["timestamp"].isString())
+        m_byTimestamp[row["timestamp"].asString()] = key;
+    if (row["sourceId"].isString())
+        m_bySource[row["sourceId"].asString()].insert(key);
+    if (row["displayId"].isNumber())
+        m_byDisplay[row["displayId"].asNumber<int>()].insert(key);
+
+    std::string collapseKey = collapseIndexKey(row);
+    if (!collapseKey.empty())
+        m_byCollapseKey[collapseKey] = key;
+
+    int64_t expire;
+    if (expireTime(row, expire))
+        m_byExpire.insert(std::make_pair(expire, key));
+}
+
+void ToastIndex::erase(RowKey key, bool notify)
+{
+    auto it = m_rows.find(key);
+    if (it == m_rows.end())
+        return;
+
+    const pbnjson::JValue& row = it->second;
+    count(row, -1, notify);
+
+    if (row["timestamp"].isString())
+        m_byTimestamp.erase(row["timestamp"].asString());
+    if (row["sourceId"].isString())
+    {
+        auto source = m_bySource.find(row["sourceId"].asString());
+        if (source != m_bySource.end())
+        {
+            source->second.erase(key);
+            if (source->second.empty())
+                m_bySource.erase(source);
+        }
+    }
+    if (row["displayId"].isNumber())
+    {
+        auto display = m_byDisplay.find(row["displayId"].asNumber<int>());
+        if (display != m_byDisplay.end())
+        {
+            display->second.erase(key);
+            if (display->second.empty())
+                m_byDisplay.erase(display);
+        }
+    }
+
+    std::string collapseKey = collapseIndexKey(row);
+    auto collapsed = m_byCollapseKey.find(collapseKey);
+    if (!collapseKey.empty() && collapsed != m_byCollapseKey.end() && collapsed->second == key)
+        m_byCollapseKey.erase(collapsed);
+
+    int64_t expire;
+    if (expireTime(row, expire))
+        m_byExpire.erase(std::make_pair(expire, key));
+
+    m_rows.erase(it);
+}
+
+std::vector<ToastIndex::RowKey> ToastIndex::candidates(const pbnjson::JValue& query) const
+{
+    std::vector<RowKey> keys;
+    pbnjson::JValue where = query["where"];
+
+    // Narrow with the first equality clause on an indexed property
+    for (ssize_t i = 0; i < where.arraySize(); ++i)
+    {
+        if (where[i]["op"].asString() != "=")
+            continue;
+
+        std::string prop = where[i]["prop"].asString();
+        pbnjson::JValue val = where[i]["val"];
+
+        if (prop == "timestamp")
+        {
+            auto it = m_byTimestamp.find(val.asString());
+            if (it != m_byTimestamp.end())
+                keys.push_back(it->second);
+            return keys;
+        }
+        if (prop == "sourceId")
+        {
+            auto it = m_bySource.find(val.asString());
+            if (it != m_bySource.end())
+                keys.assign(it->second.begin(), it->second.end());
+            return keys;
+        }
+        if (prop == "displayId")
+        {
+            auto it = m_byDisplay.find(val.asNumber<int>());
+            if (it != m_byDisplay.end())
+                keys.assign(it->second.begin(), it->second.end());
+            return keys;
+        }
+    }
+
+    keys.reserve(m_rows.size());
+    for (auto &row : m_rows)
+        keys.push_back(row.first);
+
+    return keys;
+}
+
+bool ToastIndex::matches(const pbnjson::JValue& row, const pbnjson::JValue& query)
+{
+    pbnjson::JValue where = query["where"];
+
+    for (ssize_t i = 0; i < where.arraySize(); ++i)
+    {
+        std::string prop = where[i]["prop"].asString();
+        std::string op = where[i]["op"].asString();
+        pbnjson::JValue val = where[i]["val"];
+
+        // Resolve dotted properties such as schedule.expire
+        pbnjson::JValue field = row;
+        size_t start = 0;
+        while (true)
+        {
+            size_t dot = prop.find('.', start);
+            field = field[prop.substr(start, dot - start)];
+            if (dot == std::string::npos)
+                break;
+            start = dot + 1;
+        }
+
+        if (op == "=")
+        {
+            if (field != val)
+                return false;
+        }
+        else if (op == "<")
+        {
+            if (field.isNumber() && val.isNumber())
+            {
+                if (!(field.asNumber<int64_t>() < val.asNumber<int64_t>()))
+                    return false;
+            }
+            else if (field.isString() && val.isString())
+            {
+                if (!(field.asString() < val.asString()))
+                    return false;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        else
+        {
+            LOG_DEBUG("[ToastIndex] unsupported query operator %s", op.c_str());
+            return false;
+        }
+    }
+
+    return true;
+}
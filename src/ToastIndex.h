@@ -0,0 +1,127 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __TOASTINDEX_H__
+#define __TOASTINDEX_H__
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <luna-service2/lunaservice.h>
+#include <pbnjson.hpp>
+#include <boost/signals2.hpp>
+
+/*! In-memory copy of the history kind.
+ * Loaded from db8 and then kept current by History, which applies every
+ * put/del/merge here as well as to the db8 journal. It is loaded again when
+ * db8 lost some of those writes. Rows are indexed by
+ * display, source, timestamp (the unique part of a toastId), collapse key
+ * and expire time.
+ */
+class ToastIndex
+{
+public:
+    ToastIndex();
+    ~ToastIndex();
+
+    //! Start loading the kind from db8 page by page
+    void load(LSHandle* lshandle, const std::string& kind);
+
+    /*! Drop every row and load the kind again, e.g. when db8 and the index
+     * went apart. Not ready until it is loaded. Writes still queued for db8
+     * must be sent first. False if a load is in progress or never started.
+     */
+    bool reload();
+
+    //! True once every db8 page is loaded and reads can be served from memory
+    bool isReady() const { return m_ready; }
+
+    void put(const pbnjson::JValue& row);
+    void del(const pbnjson::JValue& query);
+    void merge(const pbnjson::JValue& query, const pbnjson::JValue& props);
+
+    /*! Rows of displayId in insertion order, optionally only those with the
+     * given readStatus. At most limit rows (0 for all) are returned, starting
+     * after cursor. cursor is updated to the next page, or cleared when no
+     * rows are left. Returns false if cursor was not made by this index.
+     */
+    bool byDisplay(int displayId, const pbnjson::JValue& readStatus, size_t limit,
+                   std::string& cursor, std::vector<pbnjson::JValue>& rows) const;
+
+    //! Timestamp of the row of sourceId with collapseKey, empty if there is none
+    std::string findCollapsed(const std::string& sourceId, const std::string& collapseKey) const;
+
+    //! Earliest schedule.expire of all rows, 0 if no row has one
+    int64_t nextExpire() const;
+    //! Timestamps of the rows whose schedule.expire is before now
+    std::vector<std::string> expired(int64_t now) const;
+
+    //! True if cursor is a page of this index rather than of db8
+    static bool isCursor(const std::string& cursor);
+
+    size_t size() const { return m_rows.size(); }
+
+    //! Rows of a display with readStatus true and false
+    struct Counts {
+        int read;
+        int unread;
+    };
+    const std::map<int, Counts>& counts() const { return m_counts; }
+
+    /*! Counts of displayId changed by a put, del or merge. Rows loaded from
+     * db8 are counted in counts() but not signalled.
+     */
+    boost::signals2::signal<void (int displayId, int readDelta, int unreadDelta)> sigCountChanged;
+    //! Every db8 page is loaded
+    boost::signals2::signal<void ()> sigReady;
+
+private:
+    typedef unsigned long long RowKey;
+
+    void requestPage(LSHandle* lshandle, const std::string& page);
+    void insert(RowKey key, const pbnjson::JValue& row, bool notify = true);
+    void erase(RowKey key, bool notify = true);
+    void count(const pbnjson::JValue& row, int delta, bool notify);
+    std::vector<RowKey> candidates(const pbnjson::JValue& query) const;
+
+    void clear();
+
+    static bool matches(const pbnjson::JValue& row, const pbnjson::JValue& query);
+    static bool cbLoad(LSHandle* lshandle, LSMessage *message, void *user_data);
+
+    std::map<RowKey, pbnjson::JValue> m_rows;
+    std::unordered_map<std::string, RowKey> m_byTimestamp;
+    std::map<std::string, std::set<RowKey>> m_bySource;
+    std::map<int, std::set<RowKey>> m_byDisplay;
+    std::unordered_map<std::string, RowKey> m_byCollapseKey;     // sourceId '\n' collapseKey
+    std::set<std::pair<int64_t, RowKey>> m_byExpire;            // earliest first
+    std::map<int, Counts> m_counts;
+
+    RowKey m_nextLoadKey;
+    RowKey m_nextKey;
+
+    bool m_ready;
+    bool m_loading;
+    LSHandle* m_handle;
+    std::string m_kind;
+
+    // del/merge calls made while loading, applied to rows arriving later
+    std::vector<std::pair<pbnjson::JValue, pbnjson::JValue>> m_replay;
+};
+
+#endif
@@ -15,6 +15,8 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "Utils.h"
+#include <stdlib.h>
+#include <stdint.h>
 #include <sys/stat.h>
 #include <sys/statfs.h>
 #include <Logging.h>
@@ -107,20 +109,39 @@ std::string extractSourceIdFromCaller(const std::string& id)
     return sourceId;
 }
 
+// Last value handed out. Ids are sourceId + "-" + timestamp, so two calls
+// in the same millisecond, or after the wall clock stepped back, must still
+// get distinct, increasing values.
+static long long s_lastTimestamp = 0;
+
+void advanceTimestamp(const std::string& timestamp)
+{
+	long long timevalue = strtoll(timestamp.c_str(), NULL, 10);
+	if (timevalue > s_lastTimestamp)
+		s_lastTimestamp = timevalue;
+}
+
 void createTimestamp(std::string& timestamp)
 {
 	long long timevalue;
 	struct timeval tp;
-	std::stringstream ss;
 
 	//Get the timestamp and add it to message
 	gettimeofday(&tp, NULL);
-    timevalue = tp.tv_sec * 1000LL + tp.tv_usec / 1000; //Get the milliseconds.
-	ss << timevalue;
+	timevalue = tp.tv_sec * 1000LL + tp.tv_usec / 1000; //Get the milliseconds.
+
+	if (timevalue <= s_lastTimestamp)
+		timevalue = s_lastTimestamp + 1;
+	s_lastTimestamp = timevalue;
 
-	timestamp = ss.str();
+	char buf[24];
+	char* pos = buf + sizeof(buf);
+	do {
+		*--pos = '0' + (timevalue % 10);
+		timevalue /= 10;
+	} while (timevalue > 0);
 
-	return;
+	timestamp.assign(pos, buf + sizeof(buf) - pos);
 }
 
 bool isValidURI(const std::string& uri)
@@ -132,8 +153,138 @@ bool isValidURI(const std::string& uri)
 
 bool isEscapeChar(char c)
 {
-	const std::string escape_chars = "\n\t\v\f\r";
-	return (escape_chars.find(c) != std::string::npos);
+	return c == '\n' || c == '\t' || c == '\v' || c == '\f' || c == '\r';
+}
+
+// Byte classes for sanitizeText()
+enum {
+	TEXT_PLAIN,     // printable ASCII, copied
+	TEXT_SPACE,     // isEscapeChar(), becomes ' '
+	TEXT_STRIP,     // other C0 controls and DEL, dropped
+	TEXT_MULTIBYTE  // starts or continues a UTF-8 sequence
+};
+
+struct TextClasses
+{
+	unsigned char of[256];
+
+	TextClasses()
+	{
+		for (int c = 0; c < 256; ++c)
+		{
+			if (c >= 0x80)
+				of[c] = TEXT_MULTIBYTE;
+			else if (isEscapeChar(static_cast<char>(c)))
+				of[c] = TEXT_SPACE;
+			else if (c < 0x20 || c == 0x7f)
+				of[c] = TEXT_STRIP;
+			else
+				of[c] = TEXT_PLAIN;
+		}
+	}
+};
+
+static const TextClasses s_textClasses;
+
+//! Length of the valid UTF-8 sequence at p, 0 if invalid. cp receives the code point.
+static size_t decodeUtf8(const unsigned char* p, size_t avail, uint32_t& cp)
+{
+	size_t len;
+	uint32_t min;
+
+	if (p[0] >= 0xc2 && p[0] <= 0xdf)
+	{
+		len = 2; min = 0x80; cp = p[0] & 0x1f;
+	}
+	else if (p[0] >= 0xe0 && p[0] <= 0xef)
+	{
+		len = 3; min = 0x800; cp = p[0] & 0x0f;
+	}
+	else if (p[0] >= 0xf0 && p[0] <= 0xf4)
+	{
+		len = 4; min = 0x10000; cp = p[0] & 0x07;
+	}
+	else
+	{
+		return 0;
+	}
+
+	if (len > avail)
+		return 0;
+
+	for (size_t i = 1; i < len; ++i)
+	{
+		if ((p[i] & 0xc0) != 0x80)
+			return 0;
+		cp = (cp << 6) | (p[i] & 0x3f);
+	}
+
+	// Overlong forms, surrogates and values past U+10FFFF
+	if (cp < min || (cp >= 0xd800 && cp <= 0xdfff) || cp > 0x10ffff)
+		return 0;
+
+	return len;
+}
+
+size_t sanitizeText(std::string& text, size_t maxChars)
+{
+	const unsigned char* in = reinterpret_cast<const unsigned char*>(text.data());
+	const size_t size = text.size();
+
+	// Plain ASCII within the limit, the common case, is left untouched
+	size_t i = 0;
+	size_t limit = (maxChars && maxChars < size) ? maxChars : size;
+	while (i < limit && s_textClasses.of[in[i]] == TEXT_PLAIN)
+		++i;
+	if (i == size)
+		return size;
+
+	std::string out;
+	out.reserve(size);
+	out.append(text, 0, i);
+
+	size_t chars = i;
+	while (i < size && (!maxChars || chars < maxChars))
+	{
+		switch (s_textClasses.of[in[i]])
+		{
+		case TEXT_PLAIN:
+			out += static_cast<char>(in[i++]);
+			break;
+		case TEXT_SPACE:
+			out += ' ';
+			++i;
+			break;
+		case TEXT_STRIP:
+			++i;
+			continue;
+		default:
+		{
+			uint32_t cp;
+			size_t len = decodeUtf8(in + i, size - i, cp);
+			if (!len)
+			{
+				// Not UTF-8, write U+FFFD instead of the byte
+				out += "\xef\xbf\xbd";
+				++i;
+				break;
+			}
+			if (cp >= 0x80 && cp <= 0x9f)
+			{
+				// C1 control
+				i += len;
+				continue;
+			}
+			out.append(text, i, len);
+			i += len;
+			break;
+		}
+		}
+		++chars;
+	}
+
+	text.swap(out);
+	return chars;
 }
 
 namespace Private
@@ -31,8 +31,17 @@ namespace Utils
     char* readFile(const char* filePath);
     std::string extractTimestampFromId(const std::string& id);
     void createTimestamp(std::string& timestamp);
+    //! Make createTimestamp return values above timestamp, e.g. one loaded from history
+    void advanceTimestamp(const std::string& timestamp);
     bool isValidURI(const std::string& uri);
     bool isEscapeChar(char c);
+    /*! Make caller supplied text safe to display, in one pass: escape
+     * characters (see isEscapeChar()) become ' ', other control characters
+     * are removed, invalid UTF-8 is replaced by U+FFFD and the text is cut
+     * after maxChars code points if maxChars isn't 0. Returns the number of
+     * code points left.
+     */
+    size_t sanitizeText(std::string& text, size_t maxChars = 0);
     std::string extractSourceIdFromCaller(const std::string& id);
 
     //! Make std::string for type T
@@ -0,0 +1,191 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+// Lookup and full listApps reconcile of AppList, before and after apps were
+// indexed by id. AppList itself is tied to the LS2 handle of the service, so
+// both containers are reproduced here with the same operations:
+//  - List: std::list scanned by isAppExist() and again by getIcon(), and
+//    cleared and rebuilt on every full listApps reply
+//  - Map: unordered_map with one lookup(), full replies upsert every app
+//    with the reply's generation and sweep the apps not refreshed
+
+#include <benchmark/benchmark.h>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+std::vector<std::string> appIds(size_t count)
+{
+    std::vector<std::string> ids;
+    for (size_t i = 0; i < count; ++i)
+        ids.push_back("com.webos.app.benchmark" + std::to_string(i));
+    return ids;
+}
+
+std::string iconOf(const std::string& id)
+{
+    return "/usr/palm/applications/" + id + "/icon.png";
+}
+
+class ListApps
+{
+public:
+    void fullReply(const std::vector<std::string>& ids)
+    {
+        m_apps.clear();
+        for (const auto& id : ids)
+            m_apps.push_back(AppInfo{ id, iconOf(id) });
+    }
+
+    bool isAppExist(const std::string& id) const
+    {
+        for (const auto& app : m_apps)
+            if (app.appId == id)
+                return true;
+        return false;
+    }
+
+    std::string getIcon(const std::string& id) const
+    {
+        for (const auto& app : m_apps)
+            if (app.appId == id)
+                return app.icon;
+        return "";
+    }
+
+private:
+    struct AppInfo {
+        std::string appId;
+        std::string icon;
+    };
+    std::list<AppInfo> m_apps;
+};
+
+class MapApps
+{
+public:
+    MapApps() : m_generation(0) {}
+
+    void fullReply(const std::vector<std::string>& ids)
+    {
+        m_generation++;
+        for (const auto& id : ids)
+        {
+            std::string icon = iconOf(id);
+            auto it = m_apps.find(id);
+            if (it != m_apps.end() && it->second.icon == icon)
+            {
+                it->second.generation = m_generation;
+                continue;
+            }
+            AppInfo& app = m_apps[id];
+            app.icon = icon;
+            app.generation = m_generation;
+        }
+
+        for (auto it = m_apps.begin(); it != m_apps.end(); )
+        {
+            if (it->second.generation != m_generation)
+                it = m_apps.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    bool lookup(const std::string& id, std::string* icon) const
+    {
+        auto it = m_apps.find(id);
+        if (it == m_apps.end())
+            return false;
+        if (icon)
+            *icon = it->second.icon;
+        return true;
+    }
+
+private:
+    struct AppInfo {
+        std::string icon;
+        unsigned int generation;
+    };
+    std::unordered_map<std::string, AppInfo> m_apps;
+    unsigned int m_generation;
+};
+
+// What buildToast asks per toast: does the source exist, and its icon
+void BM_ToastLookupList(benchmark::State& state)
+{
+    std::vector<std::string> ids = appIds(state.range(0));
+    ListApps apps;
+    apps.fullReply(ids);
+
+    size_t next = 0;
+    for (auto _ : state)
+    {
+        const std::string& id = ids[next++ % ids.size()];
+        std::string icon;
+        if (apps.isAppExist(id))
+            icon = apps.getIcon(id);
+        benchmark::DoNotOptimize(icon);
+    }
+}
+BENCHMARK(BM_ToastLookupList)->Arg(50)->Arg(500)->Arg(5000);
+
+void BM_ToastLookupMap(benchmark::State& state)
+{
+    std::vector<std::string> ids = appIds(state.range(0));
+    MapApps apps;
+    apps.fullReply(ids);
+
+    size_t next = 0;
+    for (auto _ : state)
+    {
+        std::string icon;
+        apps.lookup(ids[next++ % ids.size()], &icon);
+        benchmark::DoNotOptimize(icon);
+    }
+}
+BENCHMARK(BM_ToastLookupMap)->Arg(50)->Arg(500)->Arg(5000);
+
+// A full listApps reply with the same apps, as sent on every app manager restart
+void BM_FullReplyList(benchmark::State& state)
+{
+    std::vector<std::string> ids = appIds(state.range(0));
+    ListApps apps;
+    apps.fullReply(ids);
+
+    for (auto _ : state)
+        apps.fullReply(ids);
+}
+BENCHMARK(BM_FullReplyList)->Arg(50)->Arg(500)->Arg(5000);
+
+void BM_FullReplyMap(benchmark::State& state)
+{
+    std::vector<std::string> ids = appIds(state.range(0));
+    MapApps apps;
+    apps.fullReply(ids);
+
+    for (auto _ : state)
+        apps.fullReply(ids);
+}
+BENCHMARK(BM_FullReplyMap)->Arg(50)->Arg(500)->Arg(5000);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,105 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "JsonReader.h"
+#include "RequestParsers.h"
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+// Copy of text in a buffer of exactly its size, so reading past the NUL
+// shows up under ASan like it would in an LSMessage payload
+class Payload
+{
+public:
+    explicit Payload(const std::string& text)
+        : m_data(static_cast<char*>(malloc(text.size() + 1)))
+    {
+        memcpy(m_data, text.c_str(), text.size() + 1);
+    }
+    ~Payload() { free(m_data); }
+
+    const char* c_str() const { return m_data; }
+
+private:
+    char* m_data;
+};
+
+static bool readString(const std::string& json, std::string& value)
+{
+    Payload payload(json);
+    JsonReader reader(payload.c_str());
+    return reader.readString(value);
+}
+
+TEST(JsonReader, Escapes)
+{
+    std::string value;
+    ASSERT_TRUE(readString("\"a\\\"b\\\\c\\/d\\n\\t\"", value));
+    EXPECT_EQ("a\"b\\c/d\n\t", value);
+}
+
+TEST(JsonReader, SurrogatePair)
+{
+    std::string value;
+    ASSERT_TRUE(readString("\"\\ud83d\\ude00\"", value));
+    EXPECT_EQ("\xf0\x9f\x98\x80", value);
+}
+
+TEST(JsonReader, LoneSurrogate)
+{
+    std::string value;
+    ASSERT_TRUE(readString("\"\\ud800x\"", value));
+    EXPECT_EQ("\xef\xbf\xbdx", value);
+
+    ASSERT_TRUE(readString("\"\\ud800\\u0041\"", value));
+    EXPECT_EQ("\xef\xbf\xbd" "A", value);
+
+    ASSERT_TRUE(readString("\"\\udc00\"", value));
+    EXPECT_EQ("\xef\xbf\xbd", value);
+}
+
+TEST(JsonReader, TruncatedEscape)
+{
+    // Every prefix of a surrogate pair escape, the payload ending right there
+    const std::string full = "\"\\ud800\\udc00\"";
+    for (size_t length = 1; length < full.size(); ++length)
+    {
+        std::string value;
+        EXPECT_FALSE(readString(full.substr(0, length), value)) << full.substr(0, length);
+    }
+}
+
+TEST(JsonReader, TruncatedEscapeInRequest)
+{
+    const char* cuts[] = {
+        "{\"sourceId\":\"a\",\"message\":\"\\ud800\\u",
+        "{\"sourceId\":\"a\",\"message\":\"\\ud800\\ud",
+        "{\"sourceId\":\"a\",\"message\":\"\\ud800\\udc0",
+        "{\"sourceId\":\"a\",\"message\":\"\\ud8",
+    };
+
+    for (const char* cut : cuts)
+    {
+        Payload payload(cut);
+        CreateToastRequest request;
+        std::string error;
+        EXPECT_FALSE(CreateToastRequest::parse(payload.c_str(), request, error)) << cut;
+    }
+}
@@ -0,0 +1,201 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+// The hot replies, before and after they were written with JsonWriter:
+//  - CreateToastReply: the reply to a successful createToast
+//  - Count: a getToastCount reply
+//  - List: a getToastList page, the rows as db8 returns them. Dom builds a
+//    toast info object per row into an array and serializes the reply, like
+//    toToastInfo did. Writer copies the same keys from the rows, like
+//    History::writeToastInfo does
+
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+#include <JUtil.h>
+#include <pbnjson.hpp>
+
+#include "JsonWriter.h"
+
+namespace {
+
+const char* const TOAST_INFO_KEYS[] = {
+    "timestamp", "iconUrl", "iconPath", "title", "message", "isSysReq",
+    "displayId", "user", "schedule", "type", "action", "readStatus"
+};
+
+std::vector<pbnjson::JValue> rows(size_t count)
+{
+    std::vector<pbnjson::JValue> result;
+    for (size_t i = 0; i < count; ++i)
+    {
+        std::string sourceId = "com.webos.app.benchmark" + std::to_string(i % 8);
+
+        pbnjson::JValue action = pbnjson::Object();
+        action.put("serviceURI", "palm://com.webos.applicationManager/");
+        action.put("serviceMethod", "launch");
+        action.put("launchParams", pbnjson::JObject{{"id", sourceId}});
+
+        pbnjson::JValue row = pbnjson::Object();
+        row.put("_id", "++JZ" + std::to_string(i));
+        row.put("_rev", static_cast<int64_t>(1000 + i));
+        row.put("sourceId", sourceId);
+        row.put("timestamp", std::to_string(1760745600000LL + i));
+        row.put("iconUrl", "file:///usr/palm/applications/" + sourceId + "/icon.png");
+        row.put("iconPath", "/usr/palm/applications/" + sourceId + "/icon.png");
+        row.put("title", "Notification " + std::to_string(i));
+        row.put("message", "The download has finished, open the app to see the details");
+        row.put("isSysReq", false);
+        row.put("displayId", 0);
+        row.put("user", "guest");
+        row.put("type", "standard");
+        row.put("action", action);
+        row.put("readStatus", (i % 3) == 0);
+        result.push_back(row);
+    }
+    return result;
+}
+
+void BM_CreateToastReplyDom(benchmark::State& state)
+{
+    std::string toastId = "com.webos.app.benchmark-1760745600123";
+    for (auto _ : state)
+    {
+        pbnjson::JValue reply = pbnjson::Object();
+        reply.put("returnValue", true);
+        reply.put("toastId", toastId);
+        std::string payload = JUtil::jsonToString(reply);
+        benchmark::DoNotOptimize(payload);
+    }
+}
+BENCHMARK(BM_CreateToastReplyDom);
+
+void BM_CreateToastReplyWriter(benchmark::State& state)
+{
+    static JsonWriter writer;
+    std::string toastId = "com.webos.app.benchmark-1760745600123";
+    for (auto _ : state)
+    {
+        writer.clear();
+        writer.beginObject().member("returnValue", true);
+        writer.member("toastId", toastId);
+        writer.endObject();
+        benchmark::DoNotOptimize(writer.c_str());
+    }
+}
+BENCHMARK(BM_CreateToastReplyWriter);
+
+void BM_CountDom(benchmark::State& state)
+{
+    int64_t sequence = 0;
+    for (auto _ : state)
+    {
+        pbnjson::JValue reply = pbnjson::Object();
+        reply.put("readCount", 12);
+        reply.put("unreadCount", 3);
+        reply.put("sequence", ++sequence);
+        reply.put("returnValue", true);
+        reply.put("subscribed", true);
+        std::string payload = JUtil::jsonToString(reply);
+        benchmark::DoNotOptimize(payload);
+    }
+}
+BENCHMARK(BM_CountDom);
+
+void BM_CountWriter(benchmark::State& state)
+{
+    static JsonWriter writer;
+    int64_t sequence = 0;
+    for (auto _ : state)
+    {
+        writer.clear();
+        writer.beginObject();
+        writer.member("readCount", 12);
+        writer.member("unreadCount", 3);
+        writer.member("sequence", ++sequence);
+        writer.member("returnValue", true);
+        writer.member("subscribed", true);
+        writer.endObject();
+        benchmark::DoNotOptimize(writer.c_str());
+    }
+}
+BENCHMARK(BM_CountWriter);
+
+void BM_ListDom(benchmark::State& state)
+{
+    std::vector<pbnjson::JValue> page = rows(state.range(0));
+    for (auto _ : state)
+    {
+        pbnjson::JValue toastInfoArray = pbnjson::Array();
+        for (const pbnjson::JValue& row : page)
+        {
+            pbnjson::JValue toastInfo = pbnjson::Object();
+            toastInfo.put("sourceId", row["sourceId"]);
+            toastInfo.put("toastId", row["sourceId"].asString() + "-" + row["timestamp"].asString());
+            for (const char* key : TOAST_INFO_KEYS)
+            {
+                pbnjson::JValue value = row[key];
+                if (!value.isNull())
+                    toastInfo.put(key, value);
+            }
+            toastInfoArray.append(toastInfo);
+        }
+
+        pbnjson::JValue reply = pbnjson::Object();
+        reply.put("returnValue", true);
+        reply.put("toastInfo", toastInfoArray);
+        reply.put("next", "page");
+        std::string payload = JUtil::jsonToString(reply);
+        benchmark::DoNotOptimize(payload);
+    }
+}
+BENCHMARK(BM_ListDom)->Arg(10)->Arg(50);
+
+void BM_ListWriter(benchmark::State& state)
+{
+    std::vector<pbnjson::JValue> page = rows(state.range(0));
+    static JsonWriter writer;
+    for (auto _ : state)
+    {
+        writer.clear();
+        writer.beginObject().member("returnValue", true);
+        writer.key("toastInfo").beginArray();
+        for (const pbnjson::JValue& row : page)
+        {
+            writer.beginObject();
+            writer.key("sourceId").value(row["sourceId"]);
+            writer.member("toastId", row["sourceId"].asString() + "-" + row["timestamp"].asString());
+            for (const char* key : TOAST_INFO_KEYS)
+            {
+                pbnjson::JValue value = row[key];
+                if (!value.isNull())
+                    writer.key(key).value(value);
+            }
+            writer.endObject();
+        }
+        writer.endArray();
+        writer.member("next", "page");
+        writer.endObject();
+        benchmark::DoNotOptimize(writer.c_str());
+    }
+}
+BENCHMARK(BM_ListWriter)->Arg(10)->Arg(50);
+
+}
+
+BENCHMARK_MAIN();
@@ -0,0 +1,173 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "PendingQueue.h"
+
+#include <gtest/gtest.h>
+#include <string>
+
+TEST(PendingQueue, HighPriorityFirst)
+{
+    PendingQueue<std::string> queue("test");
+    queue.push("a", false, "", 1);
+    queue.push("b", true, "", 1);
+    queue.push("c", false, "", 1);
+
+    EXPECT_EQ("b", queue.pop());
+    EXPECT_EQ("a", queue.pop());
+    EXPECT_EQ("c", queue.pop());
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(PendingQueue, CollapseMovesToTheNewLane)
+{
+    PendingQueue<std::string> queue("test");
+    queue.setLimits(2, 0, PendingQueue<std::string>::DROP_LOWEST_PRIORITY);
+
+    queue.push("old", false, "", 1, "key");
+    queue.push("other", false, "", 1);
+    ASSERT_TRUE(queue.push("new", true, "", 1, "key"));
+    EXPECT_EQ(2u, queue.size());
+    EXPECT_EQ(1u, queue.collapsed());
+
+    // A normal item makes room by dropping a normal item, not the high one
+    ASSERT_TRUE(queue.push("late", false, "", 1));
+    EXPECT_EQ("new", queue.pop());
+    EXPECT_EQ("late", queue.pop());
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(PendingQueue, CollapseKeepsTheByteBudget)
+{
+    PendingQueue<std::string> queue("test");
+    queue.setLimits(10, 100, PendingQueue<std::string>::DROP_OLDEST);
+
+    queue.push("first", false, "", 40);
+    queue.push("small", false, "", 10, "key");
+    ASSERT_TRUE(queue.push("large", false, "", 60, "key"));
+
+    // 40 + 60 fit, the superseded 10 bytes are gone
+    EXPECT_EQ(100u, queue.bytes());
+    EXPECT_EQ(2u, queue.size());
+
+    ASSERT_TRUE(queue.push("more", false, "", 50, "key"));
+    EXPECT_LE(queue.bytes(), 100u);
+    EXPECT_EQ("first", queue.pop());
+    EXPECT_EQ("more", queue.pop());
+}
+
+TEST(PendingQueue, CollapseInTheMiddleKeepsOrder)
+{
+    PendingQueue<std::string> queue("test");
+    queue.push("a", false, "", 1);
+    queue.push("b", false, "", 1, "key");
+    queue.push("c", false, "", 1);
+    queue.push("d", false, "", 1, "key");
+
+    EXPECT_EQ("a", queue.pop());
+    EXPECT_EQ("c", queue.pop());
+    EXPECT_EQ("d", queue.pop());
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(PendingQueue, DropOldestAcrossLanes)
+{
+    PendingQueue<std::string> queue("test");
+    queue.setLimits(3, 0, PendingQueue<std::string>::DROP_OLDEST);
+
+    queue.push("high", true, "", 1);
+    queue.push("a", false, "", 1);
+    queue.push("b", false, "", 1);
+
+    // The oldest item goes, even though it is high priority
+    ASSERT_TRUE(queue.push("c", false, "", 1));
+    EXPECT_EQ(3u, queue.size());
+    EXPECT_EQ(1u, queue.overflows());
+    EXPECT_EQ("a", queue.pop());
+
+    ASSERT_TRUE(queue.push("late", true, "", 1));
+    ASSERT_TRUE(queue.push("d", false, "", 1));
+    EXPECT_EQ("late", queue.pop());
+    EXPECT_EQ("c", queue.pop());
+    EXPECT_EQ("d", queue.pop());
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(PendingQueue, DropLowestPriorityKeepsTheQueueOnReject)
+{
+    PendingQueue<std::string> queue("test");
+    queue.setLimits(3, 10, PendingQueue<std::string>::DROP_LOWEST_PRIORITY);
+
+    queue.push("high", true, "", 6);
+    queue.push("small", false, "", 2, "key");
+
+    // Only normal items can go, and they don't free enough bytes
+    EXPECT_FALSE(queue.push("large", false, "", 5, "key"));
+    EXPECT_EQ(2u, queue.size());
+    EXPECT_EQ(8u, queue.bytes());
+    EXPECT_EQ(0u, queue.collapsed());
+
+    ASSERT_TRUE(queue.push("fits", false, "", 4, "key"));
+    EXPECT_EQ(1u, queue.collapsed());
+    EXPECT_EQ(10u, queue.bytes());
+
+    // A high item may drop normal ones
+    ASSERT_TRUE(queue.push("urgent", true, "", 4));
+    EXPECT_EQ("high", queue.pop());
+    EXPECT_EQ("urgent", queue.pop());
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(PendingQueue, CoalesceSourceWithinTheBudget)
+{
+    PendingQueue<std::string> queue("test");
+    queue.setLimits(2, 100, PendingQueue<std::string>::COALESCE_SOURCE);
+
+    queue.push("a1", false, "a", 30, "old");
+    queue.push("b1", false, "b", 30);
+
+    // Full, so the item of the same source is replaced in place
+    ASSERT_TRUE(queue.push("a2", false, "a", 40, "new"));
+    EXPECT_EQ(2u, queue.size());
+    EXPECT_EQ(70u, queue.bytes());
+
+    // The replacement carries the new collapse key, not the old one
+    ASSERT_TRUE(queue.push("x", false, "", 10, "new"));
+    EXPECT_EQ(1u, queue.collapsed());
+    EXPECT_EQ(40u, queue.bytes());
+
+    // A replacement too large for the budget drops the oldest items instead
+    ASSERT_TRUE(queue.push("b2", false, "b", 95));
+    EXPECT_EQ(95u, queue.bytes());
+    EXPECT_EQ(1u, queue.size());
+    EXPECT_EQ("b2", queue.pop());
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(PendingQueue, OversizedItemKeepsTheCollapsedItem)
+{
+    PendingQueue<std::string> queue("test");
+    queue.setLimits(10, 100, PendingQueue<std::string>::DROP_OLDEST);
+
+    queue.push("small", false, "", 10, "key");
+    EXPECT_FALSE(queue.push("huge", false, "", 101, "key"));
+    EXPECT_EQ(1u, queue.overflows());
+    EXPECT_EQ(0u, queue.collapsed());
+    EXPECT_EQ(10u, queue.bytes());
+    EXPECT_EQ("small", queue.pop());
+    EXPECT_TRUE(queue.empty());
+}
@@ -0,0 +1,80 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "Utils.h"
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <string>
+#include <vector>
+
+static long long wallClockMs()
+{
+    struct timeval tp;
+    gettimeofday(&tp, NULL);
+    return tp.tv_sec * 1000LL + tp.tv_usec / 1000;
+}
+
+// Stress test: ids made back to back, far faster than one per millisecond,
+// must all differ and keep increasing
+TEST(Timestamp, BurstIsStrictlyIncreasing)
+{
+    const size_t count = 100000;
+    std::vector<long long> values;
+    values.reserve(count);
+
+    long long started = wallClockMs();
+    std::string timestamp;
+    for (size_t i = 0; i < count; ++i)
+    {
+        Utils::createTimestamp(timestamp);
+        ASSERT_EQ(std::string::npos, timestamp.find_first_not_of("0123456789")) << timestamp;
+        values.push_back(strtoll(timestamp.c_str(), NULL, 10));
+    }
+
+    for (size_t i = 1; i < count; ++i)
+        ASSERT_LT(values[i - 1], values[i]) << "at " << i;
+
+    // Runs ahead of the wall clock by at most one millisecond per id
+    long long elapsed = wallClockMs() - started;
+    EXPECT_LE(values.back() - values.front(), static_cast<long long>(count) + elapsed);
+}
+
+TEST(Timestamp, AdvancedPastLoadedHistory)
+{
+    // A timestamp loaded from history, ahead of a clock that went back
+    std::string loaded = std::to_string(wallClockMs() + 60 * 60 * 1000LL);
+    Utils::advanceTimestamp(loaded);
+
+    std::string timestamp;
+    Utils::createTimestamp(timestamp);
+    EXPECT_GT(strtoll(timestamp.c_str(), NULL, 10), strtoll(loaded.c_str(), NULL, 10));
+
+    // Older timestamps don't move it back
+    Utils::advanceTimestamp("1");
+    std::string next;
+    Utils::createTimestamp(next);
+    EXPECT_GT(strtoll(next.c_str(), NULL, 10), strtoll(timestamp.c_str(), NULL, 10));
+}
+
+TEST(Timestamp, RoundTripsThroughIds)
+{
+    std::string timestamp;
+    Utils::createTimestamp(timestamp);
+    EXPECT_EQ(timestamp, Utils::extractTimestampFromId("com.webos.app.test-" + timestamp));
+}
@@ -0,0 +1,162 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+// One createToast from validation to delivery, before and after toasts were
+// passed as records. buildToast and the queues need the service, so the steps
+// they take with a toast are reproduced here:
+//  - Dom: the toast is built as a pbnjson DOM, serialized for the queue byte
+//    budget, copied into the queue, then serialized for the history and again
+//    for the subscription post
+//  - Record: a ToastRecord is filled and moved into the queue, toJson() is
+//    called once and its body is shared by the history and the post
+// The allocs counter is the number of operator new calls per toast. The C
+// core of pbnjson allocates with malloc and is not part of it.
+
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <deque>
+#include <new>
+#include <string>
+
+#include <JUtil.h>
+#include <pbnjson.hpp>
+
+#include "NotificationRecord.h"
+
+static size_t s_allocations = 0;
+
+void* operator new(size_t size)
+{
+    ++s_allocations;
+    void* p = malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+namespace {
+
+const char* SOURCE_ID = "com.webos.app.benchmark";
+const char* MESSAGE = "The download of the system update has finished, restart to install it";
+
+pbnjson::JValue buildDom()
+{
+    pbnjson::JValue launchParams = pbnjson::Object();
+    launchParams.put("id", SOURCE_ID);
+    launchParams.put("params", pbnjson::JObject{{"page", "update"}});
+
+    pbnjson::JValue action = pbnjson::Object();
+    action.put("serviceURI", "palm://com.webos.applicationManager/");
+    action.put("serviceMethod", "launch");
+    action.put("launchParams", launchParams);
+
+    pbnjson::JValue json = pbnjson::Object();
+    json.put("sourceId", SOURCE_ID);
+    json.put("displayId", 0);
+    json.put("iconUrl", "file:///usr/palm/applications/com.webos.app.benchmark/icon.png");
+    json.put("iconPath", "/usr/palm/applications/com.webos.app.benchmark/icon.png");
+    json.put("message", MESSAGE);
+    json.put("title", "System Update");
+    json.put("timestamp", "1760745600123");
+    json.put("timesource", "sdp");
+    json.put("type", "standard");
+    json.put("onlyToast", true);
+    json.put("isSysReq", false);
+    json.put("isCradleReq", false);
+    json.put("readStatus", false);
+    json.put("user", "guest");
+    json.put("action", action);
+    return json;
+}
+
+void fillRecord(ToastRecord& toast)
+{
+    toast.sourceId = SOURCE_ID;
+    toast.iconUrl = "file:///usr/palm/applications/com.webos.app.benchmark/icon.png";
+    toast.iconPath = "/usr/palm/applications/com.webos.app.benchmark/icon.png";
+    toast.message = MESSAGE;
+    toast.title = "System Update";
+    toast.timestamp = "1760745600123";
+    toast.timesource = "sdp";
+    toast.type = "standard";
+    toast.trackRead = true;
+    toast.user = "guest";
+    toast.launch = true;
+    toast.launchId = SOURCE_ID;
+    toast.launchParams = pbnjson::JObject{{"page", "update"}};
+}
+
+void countAllocations(benchmark::State& state, size_t since)
+{
+    state.counters["allocs"] = benchmark::Counter(s_allocations - since, benchmark::Counter::kAvgIterations);
+}
+
+void BM_ToastDom(benchmark::State& state)
+{
+    std::deque<pbnjson::JValue> queue;
+    size_t allocations = s_allocations;
+    for (auto _ : state)
+    {
+        pbnjson::JValue toast = buildDom();
+        size_t bytes = JUtil::jsonToString(toast).size();
+        benchmark::DoNotOptimize(bytes);
+        queue.push_back(toast.duplicate());
+
+        pbnjson::JValue queued = queue.front();
+        queue.pop_front();
+        std::string history = JUtil::jsonToString(queued);
+        queued.put("returnValue", true);
+        std::string post = JUtil::jsonToString(queued);
+        benchmark::DoNotOptimize(history);
+        benchmark::DoNotOptimize(post);
+    }
+    countAllocations(state, allocations);
+}
+BENCHMARK(BM_ToastDom);
+
+void BM_ToastRecord(benchmark::State& state)
+{
+    std::deque<ToastRecord> queue;
+    size_t allocations = s_allocations;
+    for (auto _ : state)
+    {
+        ToastRecord toast;
+        fillRecord(toast);
+        size_t bytes = toast.bytes();
+        benchmark::DoNotOptimize(bytes);
+        queue.push_back(std::move(toast));
+
+        ToastRecord queued = std::move(queue.front());
+        queue.pop_front();
+        pbnjson::JValue json = queued.toJson();
+        const std::string& history = queued.body(json);
+        std::string post = JUtil::prependMembers(history, "\"returnValue\":true");
+        benchmark::DoNotOptimize(history);
+        benchmark::DoNotOptimize(post);
+    }
+    countAllocations(state, allocations);
+}
+BENCHMARK(BM_ToastRecord);
+
+}
+
+BENCHMARK_MAIN();
@@ -0,0 +1,433 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2026 LG Electronics, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""Generate typed request structs and single pass parsers from the luna API
+schemas in files/schema.
+
+Every schema becomes a struct named after its method ("createToast" becomes
+CreateToastRequest) with a static parse() which tokenizes the payload with
+JsonReader and checks it against the schema on the way. Nested objects with
+properties become nested structs, everything the schema leaves open
+(objects without properties, arrays without items) is kept as a
+pbnjson::JValue.
+
+Supported keywords: type, properties, required, items, enum, default,
+minimum, maximum, exclusiveMinimum, exclusiveMaximum, minItems, maxItems
+and additionalProperties: false. "optional" is accepted and ignored, the
+required array is what counts. {"$ref": "other.schema"} is replaced by that
+schema file, looked up next to the referencing one, so a batch method can
+share the item schema of its single form.
+
+usage: gen_request_parsers.py --header RequestParsers.h --source RequestParsers.cpp SCHEMA...
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+
+CPP_KEYWORDS = {
+    'alignas', 'alignof', 'and', 'asm', 'auto', 'bool', 'break', 'case',
+    'catch', 'char', 'class', 'const', 'constexpr', 'continue', 'default',
+    'delete', 'do', 'double', 'else', 'enum', 'explicit', 'export', 'extern',
+    'false', 'float', 'for', 'friend', 'goto', 'if', 'inline', 'int', 'long',
+    'mutable', 'namespace', 'new', 'noexcept', 'not', 'nullptr', 'operator',
+    'or', 'private', 'protected', 'public', 'register', 'return', 'short',
+    'signed', 'sizeof', 'static', 'struct', 'switch', 'template', 'this',
+    'throw', 'true', 'try', 'typedef', 'typeid', 'typename', 'union',
+    'unsigned', 'using', 'virtual', 'void', 'volatile', 'while', 'xor',
+}
+
+SCALARS = {
+    'string': ('std::string', 'readString'),
+    'boolean': ('bool', 'readBoolean'),
+    'number': ('double', 'readNumber'),
+    'integer': ('int64_t', 'readInteger'),
+}
+
+HEADER_PROLOGUE = '''// Generated by tools/gen_request_parsers.py from files/schema, do not edit.
+
+#ifndef __REQUESTPARSERS_H__
+#define __REQUESTPARSERS_H__
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <pbnjson.hpp>
+
+#include "JsonReader.h"
+
+/*
+ * One struct per luna API schema. parse() reads the payload in a single pass
+ * and applies the schema: on success every field the request contained has
+ * set == true (fields with a schema default are always set), on failure
+ * error names the offending member, e.g. "schedule.expire: must be greater than 0".
+ */
+'''
+
+SOURCE_PROLOGUE = '''// Generated by tools/gen_request_parsers.py from files/schema, do not edit.
+
+#include "RequestParsers.h"
+
+#include <string>
+
+static bool syntaxError(std::string& error)
+{
+    error = "invalid JSON";
+    return false;
+}
+
+static bool typeError(JsonReader& reader, std::string& error, const std::string& name, const char* expected)
+{
+    if (reader.failed())
+        return syntaxError(error);
+
+    error = name + ": expected " + expected;
+    return false;
+}
+
+static bool nestedError(JsonReader& reader, std::string& error, const std::string& name)
+{
+    if (!reader.failed())
+        error = name + "." + error;
+    return false;
+}
+
+static bool invalid(std::string& error, const std::string& name, const char* reason)
+{
+    error = name + ": " + reason;
+    return false;
+}
+'''
+
+
+def capitalize(name):
+    name = re.sub(r'[^0-9A-Za-z_]', '_', name)
+    return name[:1].upper() + name[1:]
+
+
+def identifier(name):
+    name = re.sub(r'[^0-9A-Za-z_]', '_', name)
+    if not name or name[0].isdigit():
+        name = '_' + name
+    if name in CPP_KEYWORDS:
+        name += '_'
+    return name
+
+
+def literal(value):
+    if isinstance(value, bool):
+        return 'true' if value else 'false'
+    if isinstance(value, str):
+        return json.dumps(value)
+    return repr(value)
+
+
+class Struct(object):
+    def __init__(self, name, schema, parent=None):
+        self.name = name
+        self.schema = schema
+        self.parent = parent
+        self.children = []
+        self.fields = []    # (json name, member, kind, schema)
+
+    def qualified(self):
+        if self.parent is None:
+            return self.name
+        return self.parent.qualified() + '::' + self.name
+
+    def function(self):
+        return 'parse' + self.qualified().replace('::', '_')
+
+
+class Generator(object):
+    def __init__(self):
+        self.structs = []
+
+    def kind(self, schema, key, owner):
+        """C++ type for a schema, creating nested structs as needed."""
+        type_ = schema.get('type')
+        if isinstance(type_, str) and type_ in SCALARS:
+            return SCALARS[type_][0]
+        if type_ == 'object' and schema.get('properties'):
+            name = capitalize(key)
+            if name == owner.name:
+                name += 'Object'
+            return self.build(name, schema, owner).qualified()
+        if type_ == 'array' and isinstance(schema.get('items'), dict):
+            item = self.kind(schema['items'], key + 'Item', owner)
+            return 'std::vector<' + item + '>'
+        return 'pbnjson::JValue'
+
+    def build(self, name, schema, parent=None):
+        struct = Struct(name, schema, parent)
+        if parent:
+            parent.children.append(struct)
+        for key, sub in schema.get('properties', {}).items():
+            struct.fields.append((key, identifier(key), self.kind(sub, key, struct), sub))
+        self.structs.append(struct)
+        return struct
+
+    # -- declarations
+
+    def declare(self, struct, indent, out):
+        pad = '    ' * indent
+        out.append(pad + 'struct ' + struct.name)
+        out.append(pad + '{')
+        for child in struct.children:
+            self.declare(child, indent + 1, out)
+            out.append('')
+        for key, member, kind, sub in struct.fields:
+            out.append(pad + '    JsonField<' + self.local(kind, struct) + '> ' + member + ';')
+        if struct.parent is None:
+            out.append('')
+            out.append(pad + '    static bool parse(const char* payload, ' + struct.name + '& request, std::string& error);')
+        out.append(pad + '};')
+
+    @staticmethod
+    def local(kind, struct):
+        # Nested types are named relative to the enclosing struct
+        prefix = struct.qualified() + '::'
+        return kind.replace(prefix, '')
+
+    # -- parsers
+
+    def read(self, schema, kind, dst, name, out, pad, depth):
+        """Emit code reading one value of kind into dst."""
+        type_ = schema.get('type')
+        if kind in [v[0] for v in SCALARS.values()]:
+            method = SCALARS[type_][1]
+            out.append(pad + 'if (!reader.' + method + '(' + dst + '))')
+            out.append(pad + '    return typeError(reader, error, ' + name + ', "' + type_ + '");')
+        elif kind.startswith('std::vector<'):
+            item = kind[len('std::vector<'):-1]
+            index = 'index%d' % depth
+            first = 'first%d' % depth
+            out.append(pad + 'if (reader.peek() != JsonReader::BEGIN_ARRAY)')
+            out.append(pad + '    return typeError(reader, error, ' + name + ', "array");')
+            out.append(pad + 'reader.beginArray();')
+            out.append(pad + 'for (bool ' + first + ' = true; reader.nextElement(' + first + '); )')
+            out.append(pad + '{')
+            out.append(pad + '    size_t ' + index + ' = ' + dst + '.size();')
+            out.append(pad + '    ' + dst + '.emplace_back();')
+            element = 'std::string(' + name + ') + "[" + std::to_string(' + index + ') + "]"'
+            self.read(schema['items'], item, dst + '.back()', element, out, pad + '    ', depth + 1)
+            out.append(pad + '}')
+            out.append(pad + 'if (reader.failed())')
+            out.append(pad + '    return syntaxError(error);')
+        elif kind == 'pbnjson::JValue':
+            if type_ == 'object':
+                out.append(pad + 'if (reader.peek() != JsonReader::BEGIN_OBJECT)')
+                out.append(pad + '    return typeError(reader, error, ' + name + ', "object");')
+            elif type_ == 'array':
+                out.append(pad + 'if (reader.peek() != JsonReader::BEGIN_ARRAY)')
+                out.append(pad + '    return typeError(reader, error, ' + name + ', "array");')
+            out.append(pad + 'if (!reader.readValue(' + dst + '))')
+            out.append(pad + '    return typeError(reader, error, ' + name + ', "JSON value");')
+        else:
+            struct = [s for s in self.structs if s.qualified() == kind][0]
+            out.append(pad + 'if (reader.peek() != JsonReader::BEGIN_OBJECT)')
+            out.append(pad + '    return typeError(reader, error, ' + name + ', "object");')
+            out.append(pad + 'if (!' + struct.function() + '(reader, ' + dst + ', error))')
+            out.append(pad + '    return nestedError(reader, error, ' + name + ');')
+
+    def checks(self, key, member, kind, schema, out):
+        """Emit the constraints on a member which was read."""
+        field = 'out.' + member + '.value'
+        name = literal(key)
+        conds = []
+        if 'enum' in schema:
+            options = ' || '.join(field + ' == ' + literal(v) for v in schema['enum'])
+            reason = 'must be one of ' + ', '.join(str(v) for v in schema['enum'])
+            conds.append(('!(' + options + ')', reason))
+        if 'minimum' in schema:
+            if schema.get('exclusiveMinimum'):
+                conds.append((field + ' <= ' + literal(schema['minimum']),
+                              'must be greater than ' + str(schema['minimum'])))
+            else:
+                conds.append((field + ' < ' + literal(schema['minimum']),
+                              'must be at least ' + str(schema['minimum'])))
+        if 'maximum' in schema:
+            if schema.get('exclusiveMaximum'):
+                conds.append((field + ' >= ' + literal(schema['maximum']),
+                              'must be less than ' + str(schema['maximum'])))
+            else:
+                conds.append((field + ' > ' + literal(schema['maximum']),
+                              'must be at most ' + str(schema['maximum'])))
+        if kind.startswith('std::vector<'):
+            if 'minItems' in schema:
+                conds.append((field + '.size() < ' + str(schema['minItems']),
+                              'needs at least %d item%s' % (schema['minItems'], '' if schema['minItems'] == 1 else 's')))
+            if 'maxItems' in schema:
+                conds.append((field + '.size() > ' + str(schema['maxItems']),
+                              'takes at most %d item%s' % (schema['maxItems'], '' if schema['maxItems'] == 1 else 's')))
+        for cond, reason in conds:
+            out.append('    if (out.' + member + '.set && ' + cond + ')')
+            out.append('        return invalid(error, ' + name + ', ' + literal(reason) + ');')
+
+    def define(self, struct, out):
+        out.append('')
+        out.append('static bool ' + struct.function() + '(JsonReader& reader, ' + struct.qualified() + '& out, std::string& error)')
+        out.append('{')
+        out.append('    std::string key;')
+        out.append('')
+        out.append('    reader.beginObject();')
+        out.append('    for (bool first = true; reader.nextMember(key, first); )')
+        out.append('    {')
+        keyword = 'if'
+        for key, member, kind, sub in struct.fields:
+            out.append('        ' + keyword + ' (key == ' + literal(key) + ')')
+            out.append('        {')
+            self.read(sub, kind, 'out.' + member + '.value', literal(key), out, '            ', 0)
+            out.append('            out.' + member + '.set = true;')
+            out.append('        }')
+            keyword = 'else if'
+        if struct.schema.get('additionalProperties') is False:
+            if struct.fields:
+                out.append('        else')
+                out.append('            return invalid(error, key, "is not allowed");')
+            else:
+                out.append('        return invalid(error, key, "is not allowed");')
+        else:
+            out.append('        ' + ('else if' if struct.fields else 'if') + ' (!reader.skip())')
+            out.append('            return syntaxError(error);')
+        out.append('    }')
+        out.append('    if (reader.failed())')
+        out.append('        return syntaxError(error);')
+
+        members = dict((key, member) for key, member, kind, sub in struct.fields)
+        required = [k for k in struct.schema.get('required', []) if k in members]
+        if required:
+            out.append('')
+            for key in required:
+                out.append('    if (!out.' + members[key] + '.set)')
+                out.append('        return invalid(error, ' + literal(key) + ', "is required");')
+
+        constraints = []
+        for key, member, kind, sub in struct.fields:
+            self.checks(key, member, kind, sub, constraints)
+        if constraints:
+            out.append('')
+            out.extend(constraints)
+
+        defaults = [(member, sub['default']) for key, member, kind, sub in struct.fields
+                    if 'default' in sub and sub.get('type') in SCALARS]
+        if defaults:
+            out.append('')
+            for member, value in defaults:
+                out.append('    if (!out.' + member + '.set)')
+                out.append('    {')
+                out.append('        out.' + member + '.value = ' + literal(value) + ';')
+                out.append('        out.' + member + '.set = true;')
+                out.append('    }')
+
+        out.append('')
+        out.append('    return true;')
+        out.append('}')
+
+    def entry(self, struct, out):
+        out.append('')
+        out.append('bool ' + struct.name + '::parse(const char* payload, ' + struct.name + '& request, std::string& error)')
+        out.append('{')
+        out.append('    JsonReader reader(payload);')
+        out.append('')
+        out.append('    request = ' + struct.name + '();')
+        out.append('    if (reader.peek() != JsonReader::BEGIN_OBJECT)')
+        out.append('        return typeError(reader, error, "payload", "object");')
+        out.append('    if (!' + struct.function() + '(reader, request, error))')
+        out.append('        return false;')
+        out.append('    if (!reader.atEnd())')
+        out.append('        return syntaxError(error);')
+        out.append('')
+        out.append('    return true;')
+        out.append('}')
+
+
+def resolve_refs(node, base, seen=()):
+    """Return node with every {"$ref": "file.schema"} replaced by that file."""
+    if isinstance(node, list):
+        return [resolve_refs(item, base, seen) for item in node]
+    if not isinstance(node, dict):
+        return node
+    if '$ref' in node:
+        ref = node['$ref'].split('#', 1)[0]
+        if not ref or len(node) != 1:
+            sys.exit('%s: only a lone $ref to a schema file is supported' % node['$ref'])
+        path = os.path.normpath(os.path.join(base, ref))
+        if path in seen:
+            sys.exit('%s: recursive $ref' % path)
+        try:
+            with open(path) as f:
+                target = json.load(f)
+        except (IOError, ValueError) as e:
+            sys.exit('%s: %s' % (path, e))
+        target.pop('id', None)
+        return resolve_refs(target, os.path.dirname(path), seen + (path,))
+    return dict((key, resolve_refs(value, base, seen)) for key, value in node.items())
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate request parsers from luna API schemas')
+    parser.add_argument('--header', required=True)
+    parser.add_argument('--source', required=True)
+    parser.add_argument('schemas', nargs='+')
+    args = parser.parse_args()
+
+    gen = Generator()
+    roots = []
+    for path in sorted(args.schemas, key=os.path.basename):
+        with open(path) as f:
+            try:
+                schema = json.load(f)
+            except ValueError as e:
+                sys.exit('%s: %s' % (path, e))
+        schema = resolve_refs(schema, os.path.dirname(path))
+        if schema.get('type') != 'object':
+            sys.exit('%s: a request schema must describe an object' % path)
+        # Named after the file like the schema JUtil::parse() loads, some ids are copy-pasted
+        method = os.path.splitext(os.path.basename(path))[0]
+        roots.append(gen.build(capitalize(method) + 'Request', schema))
+
+    header = [HEADER_PROLOGUE]
+    for root in roots:
+        gen.declare(root, 0, header)
+        header.append('')
+    header.append('#endif')
+
+    source = [SOURCE_PROLOGUE.rstrip('\n')]
+    # Nested structs were built before their parents, so every parser is
+    # defined before it is called
+    for struct in gen.structs:
+        gen.define(struct, source)
+    for root in roots:
+        gen.entry(root, source)
+
+    for path, lines in ((args.header, header), (args.source, source)):
+        text = '\n'.join(lines) + '\n'
+        # Leave the file alone if nothing changed, to spare a rebuild
+        if os.path.exists(path):
+            with open(path) as f:
+                if f.read() == text:
+                    continue
+        with open(path, 'w') as f:
+            f.write(text)
+
+
+if __name__ == '__main__':
+    main()